@@ -6,6 +6,10 @@ MODEL_FILE="/home/user1/UC3/parser-and-code-generator/specifications/full-model.
 INTERFACE_FILE="/home/user1/UC3/parser-and-code-generator/specifications/interfaces.xml"
 TEMPLATE_PATH="/home/user1/UC3/template_skill"
 OUTPUT_BASE="/home/user1/UC3/temp-test/src/skills"
+# "cplusplus" compiles guards and assignments into a typed QScxmlCppDataModel,
+# "ecmascript" keeps the state machines interpreted by the Qt JavaScript engine,
+# it is also the input of the Qt-free backend (colcon build --cmake-args -DSKILL_STATE_MACHINE=table)
+DATAMODEL="${DATAMODEL:-cplusplus}"
 
 # Ensure the output base directory exists
 mkdir -p "$OUTPUT_BASE"
@@ -38,6 +42,12 @@ for scxml_file in "$SKILLS_DIR"/*.scxml; do
         --template_path "$TEMPLATE_PATH" \
         --output_path "$OUTPUT_BASE/${output_dir}" \
         --verbose_mode
+
+    if [ "$DATAMODEL" = "cplusplus" ]; then
+        python3 "$(dirname "$0")/generate_cpp_datamodel.py" \
+            --template_path "$TEMPLATE_PATH" \
+            "$OUTPUT_BASE/${output_dir}"
+    fi
 done
 
 echo "All skills processed."
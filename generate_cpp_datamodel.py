@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""
+Turns the ECMAScript datamodel of a skill generated by model2code into a
+typed QScxmlCppDataModel, so guards, assignments and parameters are compiled
+C++ instead of being interpreted by the Qt JavaScript engine.
+
+Usage: generate_cpp_datamodel.py --template_path <template_skill> <skill_dir>...
+
+For every skill directory (the --output_path given to model2code) it:
+  - rewrites src/<Skill>SM.scxml with datamodel="cplusplus:<Skill>DataModel:<Skill>DataModel.h",
+    the <data> elements become typed members and every expression is translated to C++
+  - writes include/<Skill>DataModel.h and src/<Skill>DataModel.cpp from the template
+  - adds the datamodel to <Skill>.h/.cpp and to the sources in CMakeLists.txt
+
+Member types are inferred from the initial values and from the literals
+assigned to them; members holding values of different types (or only values
+coming from events) stay QVariant. Skills using constructs that cannot be
+translated (ECMAScript <script>, typeof, dynamic send attributes...) keep the
+ECMAScript datamodel and the reason is printed.
+"""
+
+import argparse
+import copy
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+# the expression translator is shared with the table state machine generator
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "src", "skills", "skill_runtime", "scripts"))
+from scxml_expressions import (NS, SCXML_NS, BOOL, STRING, VARIANT, QT_DIALECT, Translator, Unsupported,  # noqa: E402
+                               infer_members, member_declarations)
+
+
+UNSUPPORTED_ELEMENTS = ("script", "foreach", "invoke", "donedata", "content", "cancel")
+UNSUPPORTED_ATTRIBUTES = ("eventexpr", "targetexpr", "typeexpr", "delayexpr", "idlocation", "namelist", "sendidexpr")
+
+
+def translate_scxml(root, class_name):
+    members = infer_members(root)
+    types = {name: kind for name, (kind, _) in members.items()}
+    translator = Translator(types, QT_DIALECT)
+    for element in root.iter():
+        tag = element.tag.replace(NS, "") if isinstance(element.tag, str) else None
+        if tag in UNSUPPORTED_ELEMENTS:
+            raise Unsupported("<%s> element" % tag)
+        for attribute in UNSUPPORTED_ATTRIBUTES:
+            if attribute in element.attrib:
+                raise Unsupported("'%s' attribute on <%s>" % (attribute, tag))
+        if "cond" in element.attrib:
+            element.set("cond", translator.typed(element.get("cond"), BOOL))
+        if tag == "param":
+            if element.get("location"):
+                element.set("expr", element.attrib.pop("location"))
+            element.set("expr", translator.value(element.get("expr") or ""))
+        if tag == "log" and element.get("expr"):
+            element.set("expr", translator.typed(element.get("expr"), STRING))
+    # <data> become members, <assign> a statement on them
+    for parent in root.iter():
+        for child in list(parent):
+            if child.tag == NS + "datamodel":
+                parent.remove(child)
+            elif child.tag == NS + "assign":
+                location = child.get("location")
+                statement = "%s = %s;" % (location, translator.typed(child.get("expr") or "", types[location]))
+                script = ET.Element(NS + "script")
+                script.text = statement
+                script.tail = child.tail
+                parent.insert(list(parent).index(child), script)
+                parent.remove(child)
+    root.set("datamodel", "cplusplus:%sDataModel:%sDataModel.h" % (class_name, class_name))
+    return members, translator
+
+
+def member_setup(members):
+    lines = []
+    for name, (kind, _) in sorted(members.items()):
+        value = 'initialDataValues.value(QStringLiteral("%s"))' % name
+        if kind != VARIANT:
+            value += ".value<%s>()" % QT_DIALECT.type(kind)
+        lines.append('\tif (initialDataValues.contains(QStringLiteral("%s"))) {\n\t\t%s = %s;\n\t}' % (name, name, value))
+    return "\n".join(lines)
+
+
+# ---------------------------------------------------------------- skill files
+
+def read(path):
+    with open(path) as handle:
+        return handle.read()
+
+
+def write(path, content):
+    with open(path, "w") as handle:
+        handle.write(content)
+
+
+def patch(files, path, pattern, replacement, marker):
+    content = files.get(path) or read(path)
+    if marker not in content:
+        content, count = re.subn(pattern, replacement, content, count=1)
+        if count != 1:
+            raise Unsupported("cannot find where to add the datamodel in %s" % path)
+    files[path] = content
+
+
+def convert_skill(skill_dir, template_path):
+    sources = os.path.join(skill_dir, "src")
+    machines = [name for name in os.listdir(sources) if name.endswith("SM.scxml")]
+    if len(machines) != 1:
+        raise Unsupported("expected one state machine in %s" % sources)
+    class_name = machines[0][:-len("SM.scxml")]
+    scxml_path = os.path.join(sources, machines[0])
+
+    parser = ET.XMLParser(target=ET.TreeBuilder(insert_comments=True))
+    tree = ET.parse(scxml_path, parser)
+    root = tree.getroot()
+    if root.get("datamodel", "").startswith("cplusplus"):
+        return class_name, "already compiled"
+    translated = copy.deepcopy(root)
+    members, translator = translate_scxml(translated, class_name)
+
+    # nothing is written before the whole state machine translated
+    header = read(os.path.join(template_path, "include", "TemplateSkillDataModel.h"))
+    source = read(os.path.join(template_path, "src", "TemplateSkillDataModel.cpp"))
+    header = header.replace("$className$", class_name).replace("/*DATA_MEMBERS*/", member_declarations(members, translator, "   "))
+    source = source.replace("$className$", class_name).replace("/*DATA_SETUP*/", member_setup(members))
+
+    data_model = class_name + "DataModel"
+    files = {
+        os.path.join(skill_dir, "include", data_model + ".h"): header,
+        os.path.join(sources, data_model + ".cpp"): source,
+    }
+    skill_header = os.path.join(skill_dir, "include", class_name + ".h")
+    patch(files, skill_header, r'(#include "%sSM.h"\n)' % class_name,
+          r'\1#include "%s.h"\n' % data_model, '"%s.h"' % data_model)
+    # declared before the state machine, which gets a pointer to it: members are
+    # constructed in declaration order and destroyed in the reverse one
+    patch(files, skill_header, r"\n([ \t]*)(\w+ m_stateMachine;\n)",
+          r"\n\1%s m_dataModel;\n\1\2" % data_model, "m_dataModel;")
+    patch(files, os.path.join(sources, class_name + ".cpp"),
+          r"(%s::%s\(std::string name \) :\s*m_name\(std::move\(name\)\)\s*\{)" % (class_name, class_name),
+          r"\1\n    m_stateMachine.setDataModel(&m_dataModel);", "setDataModel(")
+    patch(files, os.path.join(skill_dir, "CMakeLists.txt"),
+          r"(\n(\s*)\$\{CMAKE_CURRENT_SOURCE_DIR\}/include/%s\.h)" % class_name,
+          r"\1\n\2${CMAKE_CURRENT_SOURCE_DIR}/src/%s.cpp\n\2${CMAKE_CURRENT_SOURCE_DIR}/include/%s.h" % (data_model, data_model),
+          "%s.cpp" % data_model)
+
+    ET.register_namespace("", SCXML_NS)
+    ET.indent(translated, space="    ")
+    ET.ElementTree(translated).write(scxml_path, encoding="UTF-8", xml_declaration=True)
+    for path, content in files.items():
+        write(path, content)
+    return class_name, "%d typed members" % len(members)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--template_path", required=True)
+    parser.add_argument("skill_dirs", nargs="+")
+    args = parser.parse_args()
+    kept = 0
+    for skill_dir in args.skill_dirs:
+        try:
+            class_name, result = convert_skill(skill_dir, args.template_path)
+            print("%s: C++ datamodel, %s" % (class_name, result))
+        except (Unsupported, KeyError) as error:
+            kept += 1
+            print("%s: keeping the ECMAScript datamodel, %s" % (skill_dir, error))
+    return 0 if kept == 0 else 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
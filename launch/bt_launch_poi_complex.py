@@ -7,7 +7,17 @@ def generate_launch_description():
         Node(
             package='bt_executable_reload',
             executable='bt_executable_reload',
-            arguments=[ './src/behavior_tree/BT/bt_poi_complex.xml']
+            arguments=[ './src/behavior_tree/BT/bt_poi_complex.xml'],
+            parameters=[{
+                'tick_period_ms': 1000,
+                'min_tick_interval_ms': 50,
+                'watched_topics': ['/CheckNetworkComponent/NetworkChanged',
+                                   '/PeopleDetectorFilterComponent/filtered_detection',
+                                   '/battery_charging'],
+                'watched_topic_types': ['std_msgs/msg/Bool',
+                                        'std_msgs/msg/Bool',
+                                        'sensor_msgs/msg/BatteryState'],
+            }]
         ), 
     ])
 
@@ -0,0 +1,230 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file tick_path_benchmark.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <benchmark/benchmark.h>
+#include <rcutils/logging.h>
+#include <rclcpp/rclcpp.hpp>
+#include <behaviortree_cpp_v3/bt_factory.h>
+#include <bt_interfaces_dummy/msg/action_response.hpp>
+#include <bt_interfaces_dummy/msg/condition_response.hpp>
+#include <bt_interfaces_dummy/srv/tick_action.hpp>
+#include <bt_interfaces_dummy/srv/halt_action.hpp>
+#include <bt_interfaces_dummy/srv/tick_condition.hpp>
+#include <ROS2Action.h>
+#include <ROS2Condition.h>
+#include <ROS2SharedNode.h>
+#include <ServiceWarmup.h>
+#include <LatencyHistogram.h>
+
+// every benchmark takes the same three arguments
+enum Arg { SHARED_NODE = 0, INTROSPECTION = 1, MULTI_THREADED = 2 };
+
+/**
+ * Stands in for a generated skill: answers TickAction/HaltAction/TickCondition
+ * immediately with success, so only the transport and the leaf code are
+ * measured. It spins its own node on a single- or multi-threaded executor and
+ * can publish service introspection events, the two knobs that change the
+ * cost of a request on the skill side.
+ */
+class FakeSkillServer
+{
+public:
+    FakeSkillServer(bool multiThreaded, bool introspection)
+    {
+        m_node = rclcpp::Node::make_shared("BenchFakeSkill");
+        m_tickAction = m_node->create_service<bt_interfaces_dummy::srv::TickAction>("BenchActionSkill/tick",
+            [](const std::shared_ptr<bt_interfaces_dummy::srv::TickAction::Request>,
+               std::shared_ptr<bt_interfaces_dummy::srv::TickAction::Response> response)
+            {
+                response->status = bt_interfaces_dummy::msg::ActionResponse::SKILL_SUCCESS;
+                response->is_ok = true;
+            });
+        m_haltAction = m_node->create_service<bt_interfaces_dummy::srv::HaltAction>("BenchActionSkill/halt",
+            [](const std::shared_ptr<bt_interfaces_dummy::srv::HaltAction::Request>,
+               std::shared_ptr<bt_interfaces_dummy::srv::HaltAction::Response> response)
+            {
+                response->is_ok = true;
+            });
+        m_tickCondition = m_node->create_service<bt_interfaces_dummy::srv::TickCondition>("BenchConditionSkill/tick",
+            [](const std::shared_ptr<bt_interfaces_dummy::srv::TickCondition::Request>,
+               std::shared_ptr<bt_interfaces_dummy::srv::TickCondition::Response> response)
+            {
+                response->status = bt_interfaces_dummy::msg::ConditionResponse::SKILL_SUCCESS;
+                response->is_ok = true;
+            });
+        if (introspection)
+        {
+            m_tickAction->configure_introspection(m_node->get_clock(), rclcpp::SystemDefaultsQoS(), RCL_SERVICE_INTROSPECTION_CONTENTS);
+            m_haltAction->configure_introspection(m_node->get_clock(), rclcpp::SystemDefaultsQoS(), RCL_SERVICE_INTROSPECTION_CONTENTS);
+            m_tickCondition->configure_introspection(m_node->get_clock(), rclcpp::SystemDefaultsQoS(), RCL_SERVICE_INTROSPECTION_CONTENTS);
+        }
+        if (multiThreaded)
+        {
+            m_executor = std::make_shared<rclcpp::executors::MultiThreadedExecutor>();
+        }
+        else
+        {
+            m_executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+        }
+        m_executor->add_node(m_node);
+        m_threadSpin = std::thread([this]() { m_executor->spin(); });
+    }
+
+    ~FakeSkillServer()
+    {
+        m_executor->cancel();
+        m_threadSpin.join();
+        m_executor->remove_node(m_node);
+    }
+
+private:
+    rclcpp::Node::SharedPtr m_node;
+    rclcpp::Service<bt_interfaces_dummy::srv::TickAction>::SharedPtr m_tickAction;
+    rclcpp::Service<bt_interfaces_dummy::srv::HaltAction>::SharedPtr m_haltAction;
+    rclcpp::Service<bt_interfaces_dummy::srv::TickCondition>::SharedPtr m_tickCondition;
+    std::shared_ptr<rclcpp::Executor> m_executor;
+    std::thread m_threadSpin;
+};
+
+
+/**
+ * One-leaf tree talking to the fake skill, built the way bt_executable builds
+ * its leaves: on the shared node (spun by a single- or multi-threaded
+ * executor) or each on its own node.
+ */
+class LeafFixture
+{
+public:
+    LeafFixture(const benchmark::State& state, const std::string& leafXml) :
+            m_server(state.range(MULTI_THREADED), state.range(INTROSPECTION))
+    {
+        BT::BehaviorTreeFactory factory;
+        if (state.range(SHARED_NODE))
+        {
+            m_sharedNode = std::make_shared<ROS2SharedNode>("BenchLeafNode", state.range(MULTI_THREADED) ? 0 : 1);
+            auto sharedNode = m_sharedNode;
+            factory.registerBuilder<ROS2Action>("ROS2Action",
+                [sharedNode](const std::string& name, const BT::NodeConfiguration& config)
+                {
+                    return std::make_unique<ROS2Action>(name, config, sharedNode);
+                });
+            factory.registerBuilder<ROS2Condition>("ROS2Condition",
+                [sharedNode](const std::string& name, const BT::NodeConfiguration& config)
+                {
+                    return std::make_unique<ROS2Condition>(name, config, sharedNode);
+                });
+            m_sharedNode->start();
+        }
+        else
+        {
+            factory.registerNodeType<ROS2Action>("ROS2Action");
+            factory.registerNodeType<ROS2Condition>("ROS2Condition");
+        }
+        m_tree = factory.createTreeFromText("<root main_tree_to_execute=\"Bench\"><BehaviorTree ID=\"Bench\">" + leafXml + "</BehaviorTree></root>");
+        m_ready = ServiceWarmup(m_tree).waitFor(std::chrono::seconds(5)).empty();
+    }
+
+    ~LeafFixture()
+    {
+        m_tree = BT::Tree();
+        if (m_sharedNode)
+        {
+            m_sharedNode->stop();
+        }
+    }
+
+    bool ready() const
+    {
+        return m_ready;
+    }
+
+    BT::NodeStatus tick()
+    {
+        auto status = m_tree.tickRoot();
+        if (m_sharedNode)
+        {
+            m_sharedNode->haltCoordinator()->awaitPending();
+        }
+        return status;
+    }
+
+private:
+    FakeSkillServer m_server;
+    std::shared_ptr<ROS2SharedNode> m_sharedNode;
+    BT::Tree m_tree;
+    bool m_ready{false};
+};
+
+
+static void runTicks(benchmark::State& state, const std::string& leafXml)
+{
+    LeafFixture fixture(state, leafXml);
+    if (!fixture.ready())
+    {
+        state.SkipWithError("the fake skill services were not discovered");
+        return;
+    }
+    LatencyHistogram latency;
+    for (auto _ : state)
+    {
+        auto started = std::chrono::steady_clock::now();
+        // async leaves answer RUNNING until their reply arrives
+        while (fixture.tick() == BT::NodeStatus::RUNNING)
+        {
+        }
+        latency.recordSince(started);
+    }
+    state.counters["ticks_per_s"] = benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    state.counters["p50_us"] = static_cast<double>(latency.percentile(50));
+    state.counters["p99_us"] = static_cast<double>(latency.percentile(99));
+    state.counters["max_us"] = static_cast<double>(latency.max());
+}
+
+
+static void BM_ActionTick(benchmark::State& state)
+{
+    runTicks(state, "<ROS2Action name=\"BenchAction\" interface=\"ROS2SERVICE\" isMonitored=\"false\"/>");
+}
+
+
+static void BM_ActionAsyncTick(benchmark::State& state)
+{
+    runTicks(state, "<ROS2Action name=\"BenchAction\" interface=\"ROS2SERVICE\" isMonitored=\"false\" isAsync=\"true\"/>");
+}
+
+
+static void BM_ConditionTick(benchmark::State& state)
+{
+    runTicks(state, "<ROS2Condition name=\"BenchCondition\" interface=\"ROS2SERVICE\" isMonitored=\"false\"/>");
+}
+
+
+// the synchronous action path still sleeps before waiting for its reply, few
+// iterations are enough to see it
+BENCHMARK(BM_ActionTick)->ArgNames({"shared", "introspection", "multithread"})->ArgsProduct({{0, 1}, {0, 1}, {0, 1}})->Iterations(50)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ActionAsyncTick)->ArgNames({"shared", "introspection", "multithread"})->ArgsProduct({{0, 1}, {0, 1}, {0, 1}})->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ConditionTick)->ArgNames({"shared", "introspection", "multithread"})->ArgsProduct({{0, 1}, {0, 1}, {0, 1}})->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+
+int main(int argc, char** argv)
+{
+    rclcpp::init(argc, argv);
+    // the leaves log every request, which would be measured too
+    rcutils_logging_set_logger_level("rclcpp", RCUTILS_LOG_SEVERITY_WARN);
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    rclcpp::shutdown();
+    return 0;
+}
@@ -17,6 +17,13 @@
 #include <behaviortree_cpp_v3/behavior_tree.h>
 #include <ROS2Condition.h>
 #include <ROS2Action.h>
+#include <ROS2SharedNode.h>
+#include <SkillPluginLoader.h>
+#include <TickScheduler.h>
+#include <ConditionPrefetcher.h>
+#include <ServiceWarmup.h>
+#include <LatencyMonitor.h>
+#include <TraceRecorder.h>
 #include <thread>         // std::this_thread::sleep_for
 #include <chrono>         // std::chrono::seconds
 #include <behaviortree_cpp_v3/bt_factory.h>
@@ -26,6 +33,7 @@
 #include <behaviortree_cpp_v3/loggers/bt_cout_logger.h>
 #include <behaviortree_cpp_v3/loggers/bt_minitrace_logger.h>
 #include <behaviortree_cpp_v3/loggers/bt_file_logger.h>
+#include <AsyncTransitionLogger.h>
 
 
 using namespace std;
@@ -96,26 +104,143 @@ int main(int argc, char* argv[])
     RCLCPP_INFO_STREAM(rclcpp::get_logger("rclcpp"), "count "<< argc << argv[0] << argv[1] << argv[2]);
     RCLCPP_DEBUG_STREAM(rclcpp::get_logger("rclcpp"), "count "<< argc << argv[0] << argv[1] << argv[2]);
 
+    auto shared_node = std::make_shared<ROS2SharedNode>("BtExecutableNode");
+    // when true every leaf registers its clients on the node owned by the tree
+    // instead of creating its own rclcpp::Node
+    bool shared_leaf_node = shared_node->node()->declare_parameter<bool>("shared_leaf_node", true);
+    // send the requests of the leading conditions of the Reactive root evaluated in the
+    // previous tick all together when the tick starts, only possible when the shared
+    // node spins the replies
+    bool prefetch_conditions = shared_node->node()->declare_parameter<bool>("prefetch_conditions", true);
+    // round-trip latency of every leaf request, published periodically and
+    // written as JSON when the executable exits
+    auto latency_publish_period_ms = shared_node->node()->declare_parameter<int>("latency_publish_period_ms", 5000);
+    auto latency_summary_path = shared_node->node()->declare_parameter<std::string>("latency_summary_path", "/tmp/bt_latency.json");
+    auto latency_monitor = std::make_shared<LatencyMonitor>();
+    shared_node->setLatencyMonitor(latency_monitor);
+    // replies of every leaf, to be replayed offline by bt_replay
+    auto trace_path = shared_node->node()->declare_parameter<std::string>("trace_path", "");
+    std::shared_ptr<TraceRecorder> trace_recorder;
+    if (!trace_path.empty())
+    {
+        trace_recorder = std::make_shared<TraceRecorder>(trace_path);
+        shared_node->setTraceRecorder(trace_recorder);
+    }
+    if (latency_publish_period_ms > 0)
+    {
+        latency_monitor->startPublishing(shared_node->node(), "/BtExecutable/LeafLatency", std::chrono::milliseconds(latency_publish_period_ms));
+    }
+
     BehaviorTreeFactory bt_factory;
-    bt_factory.registerNodeType<ROS2Action>("ROS2Action");
-    bt_factory.registerNodeType<ROS2Condition>("ROS2Condition");
+    if (shared_leaf_node)
+    {
+        bt_factory.registerBuilder<ROS2Action>("ROS2Action",
+            [shared_node](const std::string& name, const NodeConfiguration& config)
+            {
+                return std::make_unique<ROS2Action>(name, config, shared_node);
+            });
+        bt_factory.registerBuilder<ROS2Condition>("ROS2Condition",
+            [shared_node](const std::string& name, const NodeConfiguration& config)
+            {
+                return std::make_unique<ROS2Condition>(name, config, shared_node);
+            });
+    }
+    else
+    {
+        bt_factory.registerNodeType<ROS2Action>("ROS2Action");
+        bt_factory.registerNodeType<ROS2Condition>("ROS2Condition");
+    }
     bt_factory.registerNodeType<AlwaysRunning>("AlwaysRunning");
 
+    // ticks happen every tick_period_ms, or earlier (but not more often than
+    // min_tick_interval_ms) when an async leaf gets its reply or a watched topic changes
+    auto tick_period_ms = shared_node->node()->declare_parameter<int>("tick_period_ms", 1000);
+    auto min_tick_interval_ms = shared_node->node()->declare_parameter<int>("min_tick_interval_ms", 50);
+    auto watched_topics = shared_node->node()->declare_parameter<std::vector<std::string>>("watched_topics", std::vector<std::string>());
+    auto watched_topic_types = shared_node->node()->declare_parameter<std::vector<std::string>>("watched_topic_types", std::vector<std::string>());
+    auto tick_scheduler = std::make_shared<TickScheduler>(std::chrono::milliseconds(tick_period_ms), std::chrono::milliseconds(min_tick_interval_ms));
+    shared_node->setTickScheduler(tick_scheduler);
+    // Ctrl+C wakes the main loop up instead of letting it wait for the next period
+    rclcpp::on_shutdown([tick_scheduler]() { tick_scheduler->stop(); });
+    if (watched_topics.size() != watched_topic_types.size())
+    {
+        RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "watched_topics and watched_topic_types must have the same size, no topic will be watched");
+    }
+    else
+    {
+        for (size_t i = 0; i < watched_topics.size(); i++)
+        {
+            shared_node->watchTopic(watched_topics[i], watched_topic_types[i]);
+        }
+    }
+    shared_node->start();
+
+    // skills built with BUILD_SKILL_PLUGIN run inside this process, their
+    // leaves call the state machine directly instead of the tick service
+    auto skill_plugins = shared_node->node()->declare_parameter<std::vector<std::string>>("skill_plugins", std::vector<std::string>());
+    SkillPluginLoader plugin_loader;
+    for (const auto& plugin : skill_plugins)
+    {
+        plugin_loader.load(plugin);
+    }
+
    // bt_factory.registerNodeType<FlipFlopCondition>("FlipFlopCondition");
 
     BT::Tree tree = bt_factory.createTreeFromFile(argv[1]);
 
 
-    // Create some logger
-    StdCoutLogger logger_cout(tree);
-    MinitraceLogger logger_minitrace(tree, "/tmp/bt_trace.json");
-    FileLogger logger_file(tree, "/tmp/bt_trace.fbl");
+    // Create loggers: "async" enqueues binary records written by a background
+    // thread (bt_log_convert turns them into .fbl/minitrace), "legacy" attaches
+    // the synchronous cout, minitrace and file loggers
+    auto transition_logger = shared_node->node()->declare_parameter<std::string>("transition_logger", "async");
+    auto transition_log_path = shared_node->node()->declare_parameter<std::string>("transition_log_path", "/tmp/bt_trace");
+    auto transition_log_file_size_mb = shared_node->node()->declare_parameter<int>("transition_log_file_size_mb", 16);
+    auto transition_log_files = shared_node->node()->declare_parameter<int>("transition_log_files", 4);
+    auto transition_log_sample_every = shared_node->node()->declare_parameter<int>("transition_log_sample_every", 1);
+    std::unique_ptr<StdCoutLogger> logger_cout;
+    std::unique_ptr<MinitraceLogger> logger_minitrace;
+    std::unique_ptr<FileLogger> logger_file;
+    std::shared_ptr<TransitionLogWriter> transition_log_writer;
+    std::unique_ptr<AsyncTransitionLogger> logger_async;
+    if (transition_logger == "legacy")
+    {
+        logger_cout = std::make_unique<StdCoutLogger>(tree);
+        logger_minitrace = std::make_unique<MinitraceLogger>(tree, "/tmp/bt_trace.json");
+        logger_file = std::make_unique<FileLogger>(tree, "/tmp/bt_trace.fbl");
+    }
+    else
+    {
+        transition_log_writer = std::make_shared<TransitionLogWriter>(transition_log_path,
+                                                                      static_cast<size_t>(transition_log_file_size_mb) * 1024 * 1024,
+                                                                      static_cast<size_t>(transition_log_files));
+        logger_async = std::make_unique<AsyncTransitionLogger>(tree, transition_log_writer, static_cast<unsigned>(transition_log_sample_every));
+    }
 
 #ifdef ZMQ_FOUND
     PublisherZMQ publisher_zmq(tree);
 #endif
     printTreeRecursively(tree.rootNode());
 
+    // wait for all the skills together before the first tick, for warmup_timeout_ms
+    // at most; only the ones listed in required_skills (none by default) must be up
+    // before ticking starts, the leaves of the missing ones fail until they show up
+    auto warmup_timeout_ms = shared_node->node()->declare_parameter<int>("warmup_timeout_ms", 30000);
+    auto required_skills = shared_node->node()->declare_parameter<std::vector<std::string>>("required_skills", std::vector<std::string>());
+    ServiceWarmup warmup(tree);
+    if (!warmup.waitUntilReady(std::chrono::milliseconds(warmup_timeout_ms), std::set<std::string>(required_skills.begin(), required_skills.end())))
+    {
+        shared_node->stop();
+        plugin_loader.stop();
+        rclcpp::shutdown();
+        return 1;
+    }
+
+    ConditionPrefetcher prefetcher(shared_node);
+    if (shared_leaf_node && prefetch_conditions)
+    {
+        prefetcher.setTree(tree);
+    }
+
 
     //bool is_ok = true;
     vector<TreeNode::Ptr> all_nodes_prt = tree.nodes;
@@ -154,7 +279,7 @@ int main(int argc, char* argv[])
 
 
     // uint64_t tick_cnt = 0;
-    while(true)
+    while (rclcpp::ok())
     {
         // TODO is this only for debug/control? who receives this tick?
         // yarp::os::Bottle msg;
@@ -170,9 +295,29 @@ int main(int argc, char* argv[])
         // auto& breply [[maybe_unused]] = msg.addList();
         // port.write(msg);
 
+        if (trace_recorder)
+        {
+            trace_recorder->beginTick();
+        }
+        prefetcher.beforeTick();
         tree.tickRoot();
-        std::this_thread::sleep_for (std::chrono::milliseconds(1000));
+        // halts sent during the tick were all in flight together, each one is
+        // bounded by the deadline and retries of its leaf
+        shared_node->haltCoordinator()->awaitPending();
+        prefetcher.afterTick();
+
+        if (!tick_scheduler->waitForNextTick())
+        {
+            break;
+        }
     }
 
+    shared_node->stop();
+    if (!latency_summary_path.empty())
+    {
+        latency_monitor->dumpJson(latency_summary_path);
+    }
+    plugin_loader.stop();
+    rclcpp::shutdown();
     return 0;
 }
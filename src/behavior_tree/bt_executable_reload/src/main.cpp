@@ -17,7 +17,16 @@
 #include <behaviortree_cpp_v3/behavior_tree.h>
 #include <ROS2Condition.h>
 #include <ROS2Action.h>
+#include <ROS2SharedNode.h>
+#include <SkillPluginLoader.h>
+#include <TickScheduler.h>
+#include <ConditionPrefetcher.h>
+#include <ServiceWarmup.h>
+#include <LatencyMonitor.h>
+#include <TraceRecorder.h>
+#include <TreeReloader.h>
 #include <thread>         // std::this_thread::sleep_for
+#include <mutex>
 #include <chrono>         // std::chrono::seconds
 #include <behaviortree_cpp_v3/bt_factory.h>
 #include <behaviortree_cpp_v3/actions/always_failure_node.h>
@@ -26,6 +35,7 @@
 #include <behaviortree_cpp_v3/loggers/bt_cout_logger.h>
 #include <behaviortree_cpp_v3/loggers/bt_minitrace_logger.h>
 #include <behaviortree_cpp_v3/loggers/bt_file_logger.h>
+#include <AsyncTransitionLogger.h>
 
 #include <rclcpp/rclcpp.hpp>
 #include <bt_interfaces_dummy/srv/reload_tree.hpp>
@@ -90,14 +100,11 @@ private:
 
 void ReloadTree(const std::shared_ptr<bt_interfaces_dummy::srv::ReloadTree::Request> request,
                 std::shared_ptr<bt_interfaces_dummy::srv::ReloadTree::Response> response,
-                std::unique_ptr<BT::Tree>& tree, const std::string file_path, bool halt, BehaviorTreeFactory bt_factory, std::unique_ptr<PublisherZMQ>& publisher_zmq)
+                TreeReloader& reloader, const std::string file_path)
 {
-    RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Reloading the behavior tree...");
-    publisher_zmq.reset();
-    tree = std::make_unique<BT::Tree>( bt_factory.createTreeFromFile( file_path ) );
-    publisher_zmq = std::make_unique<PublisherZMQ>(*tree);
-    RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Done reloading the behavior tree...");
-    response->is_ok = true;
+    // the new tree is built in background and swapped in by the ticking loop,
+    // is_ok only tells that the reload has been started
+    response->is_ok = reloader.requestReload(file_path);
 }
 
 int main(int argc, char* argv[])
@@ -112,24 +119,112 @@ int main(int argc, char* argv[])
 
     RCLCPP_INFO_STREAM(rclcpp::get_logger("rclcpp"), "count " << argc << argv[0] << argv[1] << argv[2]);
 
+    auto shared_node = std::make_shared<ROS2SharedNode>("BtExecutableNode");
+    rclcpp::Node::SharedPtr m_node = shared_node->node();
+    // when true every leaf registers its clients on the node owned by the tree
+    // instead of creating its own rclcpp::Node
+    bool shared_leaf_node = m_node->declare_parameter<bool>("shared_leaf_node", true);
+    // send the requests of the leading conditions of the Reactive root evaluated in the
+    // previous tick all together when the tick starts, only possible when the shared
+    // node spins the replies
+    bool prefetch_conditions = m_node->declare_parameter<bool>("prefetch_conditions", true);
+    // round-trip latency of every leaf request, published periodically and
+    // written as JSON when the executable exits
+    auto latency_publish_period_ms = m_node->declare_parameter<int>("latency_publish_period_ms", 5000);
+    auto latency_summary_path = m_node->declare_parameter<std::string>("latency_summary_path", "/tmp/bt_latency.json");
+    auto latency_monitor = std::make_shared<LatencyMonitor>();
+    shared_node->setLatencyMonitor(latency_monitor);
+    // replies of every leaf, to be replayed offline by bt_replay
+    auto trace_path = m_node->declare_parameter<std::string>("trace_path", "");
+    std::shared_ptr<TraceRecorder> trace_recorder;
+    if (!trace_path.empty())
+    {
+        trace_recorder = std::make_shared<TraceRecorder>(trace_path);
+        shared_node->setTraceRecorder(trace_recorder);
+    }
+    if (latency_publish_period_ms > 0)
+    {
+        latency_monitor->startPublishing(shared_node->node(), "/BtExecutable/LeafLatency", std::chrono::milliseconds(latency_publish_period_ms));
+    }
+
     BehaviorTreeFactory bt_factory;
-    bt_factory.registerNodeType<ROS2Action>("ROS2Action");
-    bt_factory.registerNodeType<ROS2Condition>("ROS2Condition");
+    if (shared_leaf_node)
+    {
+        bt_factory.registerBuilder<ROS2Action>("ROS2Action",
+            [shared_node](const std::string& name, const NodeConfiguration& config)
+            {
+                return std::make_unique<ROS2Action>(name, config, shared_node);
+            });
+        bt_factory.registerBuilder<ROS2Condition>("ROS2Condition",
+            [shared_node](const std::string& name, const NodeConfiguration& config)
+            {
+                return std::make_unique<ROS2Condition>(name, config, shared_node);
+            });
+    }
+    else
+    {
+        bt_factory.registerNodeType<ROS2Action>("ROS2Action");
+        bt_factory.registerNodeType<ROS2Condition>("ROS2Condition");
+    }
     bt_factory.registerNodeType<AlwaysRunning>("AlwaysRunning");
 
-    rclcpp::Node::SharedPtr m_node = rclcpp::Node::make_shared("BtExecutableNode");
-    
+    // ticks happen every tick_period_ms, or earlier (but not more often than
+    // min_tick_interval_ms) when an async leaf gets its reply or a watched topic changes
+    auto tick_period_ms = m_node->declare_parameter<int>("tick_period_ms", 1000);
+    auto min_tick_interval_ms = m_node->declare_parameter<int>("min_tick_interval_ms", 50);
+    auto watched_topics = m_node->declare_parameter<std::vector<std::string>>("watched_topics", std::vector<std::string>());
+    auto watched_topic_types = m_node->declare_parameter<std::vector<std::string>>("watched_topic_types", std::vector<std::string>());
+    auto tick_scheduler = std::make_shared<TickScheduler>(std::chrono::milliseconds(tick_period_ms), std::chrono::milliseconds(min_tick_interval_ms));
+    shared_node->setTickScheduler(tick_scheduler);
+    // Ctrl+C wakes the main loop up instead of letting it wait for the next period
+    rclcpp::on_shutdown([tick_scheduler]() { tick_scheduler->stop(); });
+    if (watched_topics.size() != watched_topic_types.size())
+    {
+        RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "watched_topics and watched_topic_types must have the same size, no topic will be watched");
+    }
+    else
+    {
+        for (size_t i = 0; i < watched_topics.size(); i++)
+        {
+            shared_node->watchTopic(watched_topics[i], watched_topic_types[i]);
+        }
+    }
+
 
     // Create the tree
     // BT::Tree tree = bt_factory.createTreeFromFile(argv[1]);
     auto tree = std::make_unique<BT::Tree>( bt_factory.createTreeFromFile( argv[1] ) );
     const std::string path = argv[1];
-    bool halt = false;
+    // how long a reloaded tree waits for its skills before being used anyway
+    auto reload_discovery_timeout_ms = m_node->declare_parameter<int>("reload_discovery_timeout_ms", 5000);
+    TreeReloader reloader(bt_factory, std::chrono::milliseconds(reload_discovery_timeout_ms));
 
-    // Create loggers
-    StdCoutLogger logger_cout(*tree);
-    MinitraceLogger logger_minitrace(*tree, "/tmp/bt_trace.json");
-    FileLogger logger_file(*tree, "/tmp/bt_trace.fbl");
+    // Create loggers: "async" enqueues binary records written by a background
+    // thread (bt_log_convert turns them into .fbl/minitrace), "legacy" attaches
+    // the synchronous cout, minitrace and file loggers
+    auto transition_logger = m_node->declare_parameter<std::string>("transition_logger", "async");
+    auto transition_log_path = m_node->declare_parameter<std::string>("transition_log_path", "/tmp/bt_trace");
+    auto transition_log_file_size_mb = m_node->declare_parameter<int>("transition_log_file_size_mb", 16);
+    auto transition_log_files = m_node->declare_parameter<int>("transition_log_files", 4);
+    auto transition_log_sample_every = m_node->declare_parameter<int>("transition_log_sample_every", 1);
+    std::unique_ptr<StdCoutLogger> logger_cout;
+    std::unique_ptr<MinitraceLogger> logger_minitrace;
+    std::unique_ptr<FileLogger> logger_file;
+    std::shared_ptr<TransitionLogWriter> transition_log_writer;
+    std::unique_ptr<AsyncTransitionLogger> logger_async;
+    if (transition_logger == "legacy")
+    {
+        logger_cout = std::make_unique<StdCoutLogger>(*tree);
+        logger_minitrace = std::make_unique<MinitraceLogger>(*tree, "/tmp/bt_trace.json");
+        logger_file = std::make_unique<FileLogger>(*tree, "/tmp/bt_trace.fbl");
+    }
+    else
+    {
+        transition_log_writer = std::make_shared<TransitionLogWriter>(transition_log_path,
+                                                                      static_cast<size_t>(transition_log_file_size_mb) * 1024 * 1024,
+                                                                      static_cast<size_t>(transition_log_files));
+        logger_async = std::make_unique<AsyncTransitionLogger>(*tree, transition_log_writer, static_cast<unsigned>(transition_log_sample_every));
+    }
 
 #ifdef ZMQ_FOUND
     // PublisherZMQ publisher_zmq(tree);
@@ -140,19 +235,99 @@ int main(int argc, char* argv[])
     rclcpp::Service<bt_interfaces_dummy::srv::ReloadTree>::SharedPtr m_reloadTreeService = 
         m_node->create_service<bt_interfaces_dummy::srv::ReloadTree>(
             "/BtExecutable/ReloadTree",
-            [&tree, &path, &halt, &bt_factory, &publisher_zmq](const std::shared_ptr<bt_interfaces_dummy::srv::ReloadTree::Request> request,
+            [&reloader, &path](const std::shared_ptr<bt_interfaces_dummy::srv::ReloadTree::Request> request,
                     std::shared_ptr<bt_interfaces_dummy::srv::ReloadTree::Response> response)
             {
-                ReloadTree(request, response, tree, path, halt, bt_factory, publisher_zmq);
+                ReloadTree(request, response, reloader, path);
             });
+    shared_node->start();
+
+    // skills built with BUILD_SKILL_PLUGIN run inside this process, their
+    // leaves call the state machine directly instead of the tick service
+    auto skill_plugins = m_node->declare_parameter<std::vector<std::string>>("skill_plugins", std::vector<std::string>());
+    SkillPluginLoader plugin_loader;
+    for (const auto& plugin : skill_plugins)
+    {
+        plugin_loader.load(plugin);
+    }
+
+    // wait for all the skills together before the first tick, for warmup_timeout_ms
+    // at most; only the ones listed in required_skills (none by default) must be up
+    // before ticking starts, the leaves of the missing ones fail until they show up
+    auto warmup_timeout_ms = m_node->declare_parameter<int>("warmup_timeout_ms", 30000);
+    auto required_skills = m_node->declare_parameter<std::vector<std::string>>("required_skills", std::vector<std::string>());
+    ServiceWarmup warmup(*tree);
+    if (!warmup.waitUntilReady(std::chrono::milliseconds(warmup_timeout_ms), std::set<std::string>(required_skills.begin(), required_skills.end())))
+    {
+        shared_node->stop();
+        plugin_loader.stop();
+        rclcpp::shutdown();
+        return 1;
+    }
+
+    ConditionPrefetcher prefetcher(shared_node);
+    BT::Tree* prefetcher_tree = nullptr;
     while (rclcpp::ok())
     {
+        // only this thread touches the tree, a reloaded one is swapped in between two ticks
+        auto reloaded_tree = reloader.takeReadyTree();
+        if (reloaded_tree)
+        {
+#ifdef ZMQ_FOUND
+            publisher_zmq.reset();
+#endif
+            // the loggers subscribe to the nodes of one tree, they follow it; the
+            // legacy ones start their files again with the new tree
+            logger_async.reset();
+            logger_cout.reset();
+            logger_minitrace.reset();
+            logger_file.reset();
+            tree = std::move(reloaded_tree);
+            if (transition_log_writer)
+            {
+                logger_async = std::make_unique<AsyncTransitionLogger>(*tree, transition_log_writer, static_cast<unsigned>(transition_log_sample_every));
+            }
+            else
+            {
+                logger_cout = std::make_unique<StdCoutLogger>(*tree);
+                logger_minitrace = std::make_unique<MinitraceLogger>(*tree, "/tmp/bt_trace.json");
+                logger_file = std::make_unique<FileLogger>(*tree, "/tmp/bt_trace.fbl");
+            }
+#ifdef ZMQ_FOUND
+            publisher_zmq = std::make_unique<PublisherZMQ>(*tree);
+#endif
+            printTreeRecursively((*tree).rootNode());
+            prefetcher_tree = nullptr;
+        }
+        if (shared_leaf_node && prefetch_conditions && prefetcher_tree != tree.get())
+        {
+            // first tick or the tree has just been reloaded
+            prefetcher.setTree(*tree);
+            prefetcher_tree = tree.get();
+        }
+        if (trace_recorder)
+        {
+            trace_recorder->beginTick();
+        }
+        prefetcher.beforeTick();
         (*tree).tickRoot();
-        rclcpp::spin_some(m_node);
+        // halts sent during the tick were all in flight together, each one is
+        // bounded by the deadline and retries of its leaf
+        shared_node->haltCoordinator()->awaitPending();
+        prefetcher.afterTick();
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        if (!tick_scheduler->waitForNextTick())
+        {
+            break;
+        }
     }
 
+    shared_node->stop();
+    if (!latency_summary_path.empty())
+    {
+        latency_monitor->dumpJson(latency_summary_path);
+    }
+    plugin_loader.stop();
     rclcpp::shutdown();
     return 0;
 }
\ No newline at end of file
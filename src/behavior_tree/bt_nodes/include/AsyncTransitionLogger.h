@@ -0,0 +1,40 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file AsyncTransitionLogger.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <behaviortree_cpp_v3/loggers/abstract_logger.h>
+#include <TransitionLogWriter.h>
+
+/**
+ * Status change logger that only enqueues a 16 byte record per transition,
+ * the file is written by the TransitionLogWriter thread. With sampleEvery N
+ * only one span every N is kept, a span being the transitions of a node from
+ * the one leaving IDLE to the one back to IDLE: the RUNNING transition and
+ * the one completing it are kept or dropped together. bt_log_convert turns the log back
+ * into the .fbl and minitrace formats of the FileLogger and MinitraceLogger.
+ */
+class AsyncTransitionLogger : public BT::StatusChangeLogger
+{
+public:
+    AsyncTransitionLogger(const BT::Tree& tree, std::shared_ptr<TransitionLogWriter> writer, unsigned sampleEvery = 1);
+    void callback(BT::Duration timestamp, const BT::TreeNode& node, BT::NodeStatus prev_status, BT::NodeStatus status) override;
+    void flush() override;
+
+private:
+    std::shared_ptr<TransitionLogWriter> m_writer;
+    unsigned m_sampleEvery;
+    unsigned m_sampleCounter{0};
+    // by node UID, whether its current span is logged
+    std::unordered_map<uint16_t, bool> m_sampledSpans;
+};
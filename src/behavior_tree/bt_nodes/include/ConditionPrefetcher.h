@@ -0,0 +1,56 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file ConditionPrefetcher.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <behaviortree_cpp_v3/bt_factory.h>
+#include <bt_interfaces_dummy/srv/tick_batch.hpp>
+#include <ROS2Condition.h>
+#include <ROS2SharedNode.h>
+
+/**
+ * Sends, at the beginning of a tick, the TickCondition requests of the
+ * conditions that were evaluated during the previous tick and that lead the
+ * root of the tree, when it is a ReactiveSequence or ReactiveFallback
+ * (possibly below decorators): they are re-evaluated at every tick before
+ * anything else. Conditions after an action, or leading a nested Reactive
+ * node, are never prefetched: they have to see what the actions ticked
+ * earlier in the same traversal did. The requests run concurrently and each leaf then reads its own reply
+ * when it is ticked, so the traversal waits for the slowest condition
+ * instead of the sum of all of them.
+ * Conditions must be free of side effects for this to be safe: a prefetched
+ * condition may end up not being evaluated in this tick.
+ * Conditions declaring the same host are prefetched with a single TickBatch
+ * request to <host>/TickBatch; a host that is not available falls back to
+ * the per-skill requests.
+ */
+class ConditionPrefetcher
+{
+public:
+    explicit ConditionPrefetcher(std::shared_ptr<ROS2SharedNode> sharedNode = nullptr);
+    ConditionPrefetcher(const BT::Tree& tree, std::shared_ptr<ROS2SharedNode> sharedNode = nullptr);
+    void setTree(const BT::Tree& tree);
+    void beforeTick();
+    void afterTick();
+
+private:
+    struct Entry
+    {
+        ROS2Condition* condition;
+        bool tickedLastTime;
+    };
+    std::vector<Entry> m_conditions;
+    std::shared_ptr<ROS2SharedNode> m_sharedNode;
+};
@@ -0,0 +1,53 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file HaltCoordinator.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Collects the halt requests sent by the leaves during a tick. ROS2Action::halt()
+ * only sends its request and registers a poll function here, so when a
+ * reactive node preempts several running actions all the halts are in flight
+ * at the same time. awaitPending() is called by the executable after the tick
+ * and polls them together; every leaf bounds its own halt with its deadline
+ * and retry budget, so the wait is bounded by the slowest leaf.
+ */
+class HaltCoordinator
+{
+public:
+    enum class HaltState { PENDING, DONE, FAILED };
+    using Poll = std::function<HaltState()>;
+
+    void add(const void* owner, const std::string& leaf, Poll poll);
+    void remove(const void* owner);
+    bool isPending(const void* owner);
+    std::vector<std::string> awaitPending(std::chrono::milliseconds pollPeriod = std::chrono::milliseconds(1));
+    size_t failedCount() const;
+
+private:
+    struct PendingHalt
+    {
+        std::string leaf;
+        Poll poll;
+    };
+
+    std::mutex m_mutex;
+    // keyed by leaf instance, the same skill can appear in several leaves
+    std::map<const void*, PendingHalt> m_pending;
+    std::atomic<size_t> m_failed{0};
+};
@@ -0,0 +1,46 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file LatencyHistogram.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Lock-free histogram of durations in microseconds with HDR-style buckets:
+ * every power of two is split in 32 linear sub-buckets, so any recorded
+ * value is reported with an error below about 3%, from 1 us to ~25 days.
+ * record() only touches atomics and can be called from any thread.
+ */
+class LatencyHistogram
+{
+public:
+    void record(uint64_t microseconds);
+    void recordSince(std::chrono::steady_clock::time_point start);
+    uint64_t count() const;
+    uint64_t max() const;
+    uint64_t percentile(double percent) const;
+
+private:
+    static constexpr unsigned SUB_BUCKET_BITS = 5;
+    static constexpr unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr unsigned MAX_MSB = 40;
+    static constexpr unsigned BUCKETS = SUB_BUCKETS * (MAX_MSB - SUB_BUCKET_BITS + 2);
+
+    static unsigned bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(unsigned index);
+
+    std::array<std::atomic<uint64_t>, BUCKETS> m_buckets{};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_max{0};
+};
@@ -0,0 +1,44 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file LatencyMonitor.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <rclcpp/rclcpp.hpp>
+#include <bt_interfaces_dummy/msg/leaf_latency_array.hpp>
+#include <LatencyHistogram.h>
+
+/**
+ * Round-trip latency of the requests sent by the leaves, one histogram per
+ * leaf name and request kind (tick, halt, batch). Leaves get their
+ * histograms once when they are built and then record without locking.
+ * The percentiles are published periodically and dumped as JSON on exit.
+ */
+class LatencyMonitor
+{
+public:
+    std::shared_ptr<LatencyHistogram> histogram(const std::string& leaf, const std::string& request);
+    void startPublishing(std::shared_ptr<rclcpp::Node> node, const std::string& topic, std::chrono::milliseconds period);
+    bt_interfaces_dummy::msg::LeafLatencyArray summary();
+    bool dumpJson(const std::string& path);
+
+private:
+    void publish();
+
+    std::mutex m_mutex;
+    std::map<std::pair<std::string, std::string>, std::shared_ptr<LatencyHistogram>> m_histograms;
+    rclcpp::Publisher<bt_interfaces_dummy::msg::LeafLatencyArray>::SharedPtr m_publisher;
+    rclcpp::TimerBase::SharedPtr m_timer;
+};
@@ -15,28 +15,90 @@
 #include <string>
 #include <bt_interfaces_dummy/msg/action_response.hpp>
 #include <mutex>
+#include <chrono>
+#include <future>
+#include <optional>
 #include <bt_interfaces_dummy/srv/tick_action.hpp>
 #include <bt_interfaces_dummy/srv/halt_action.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <behaviortree_cpp_v3/action_node.h>
+#include <ROS2SharedNode.h>
+#include <SkillTickRegistry.h>
 
 class ROS2Action :  public BT::ActionNodeBase
 {
 public:
     ROS2Action (const std::string name, const BT::NodeConfiguration &config);
+    ROS2Action (const std::string name, const BT::NodeConfiguration &config, std::shared_ptr<ROS2SharedNode> sharedNode);
+    ~ROS2Action();
     int sendTickToSkill();
+    int sendAsyncTickToSkill();
     void halt() override;
     BT::NodeStatus tick() override;
     bool init();
+    bool isConnected();
     bool stop();
     static BT::PortsList providedPorts();
 
 private:
+    bool isInProcess();
+
+    template <typename FutureT>
+    bool waitForResponse(FutureT& future)
+    {
+        if(!m_sharedNode)
+        {
+            return rclcpp::spin_until_future_complete(m_node, future) == rclcpp::FutureReturnCode::SUCCESS;
+        }
+        // the shared node is spun by its own executor, here we only wait
+        while(future.wait_for(std::chrono::seconds(1)) != std::future_status::ready)
+        {
+            if(!rclcpp::ok())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename FutureT>
+    bool isResponseReady(FutureT& future)
+    {
+        if(!m_sharedNode)
+        {
+            return rclcpp::spin_until_future_complete(m_node, future, std::chrono::milliseconds(0)) == rclcpp::FutureReturnCode::SUCCESS;
+        }
+        return future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready;
+    }
+
+    void cancelPendingTick();
+    bool sendHaltToSkill();
+    void startHaltAttempt();
+    HaltCoordinator::HaltState pollHalt();
+    bool waitForHalt();
+    void finishPendingHalt();
+    void cancelPendingHalt();
+
     std::mutex m_requestMutex;
+    std::shared_ptr<LatencyHistogram> m_tickLatency;
+    std::shared_ptr<LatencyHistogram> m_haltLatency;
+    std::shared_ptr<TraceRecorder> m_traceRecorder;
     rclcpp::Client<bt_interfaces_dummy::srv::TickAction>::SharedPtr m_clientTick;
     rclcpp::Client<bt_interfaces_dummy::srv::HaltAction>::SharedPtr m_clientHalt;
     std::shared_ptr<rclcpp::Node> m_node;
+    std::shared_ptr<ROS2SharedNode> m_sharedNode;
     std::string m_name;
     std::string m_suffixMonitor;
+    bool m_isAsync{false};
+    std::chrono::milliseconds m_deadline{0};
+    std::optional<rclcpp::Client<bt_interfaces_dummy::srv::TickAction>::SharedFutureAndRequestId> m_pendingTick;
+    std::optional<std::chrono::steady_clock::time_point> m_pendingSince;
+    std::chrono::milliseconds m_haltDeadline{1000};
+    unsigned m_haltRetries{2};
+    unsigned m_haltAttempts{0};
+    std::chrono::steady_clock::time_point m_haltSince;
+    static constexpr std::chrono::milliseconds HALT_RETRY_PERIOD{100};
+    std::chrono::steady_clock::time_point m_haltTriedAt;
+    std::optional<rclcpp::Client<bt_interfaces_dummy::srv::HaltAction>::SharedFutureAndRequestId> m_pendingHalt;
 };
 
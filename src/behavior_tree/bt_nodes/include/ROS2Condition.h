@@ -14,25 +14,73 @@
 
 #include <bt_interfaces_dummy/msg/condition_response.hpp>
 #include <mutex>
+#include <chrono>
+#include <future>
+#include <optional>
 #include <bt_interfaces_dummy/srv/tick_condition.hpp>
+#include <bt_interfaces_dummy/srv/tick_batch.hpp>
 #include <string>
 #include<behaviortree_cpp_v3/condition_node.h>
 #include <rclcpp/rclcpp.hpp>
+#include <ROS2SharedNode.h>
+#include <SkillTickRegistry.h>
 
 class ROS2Condition :  public BT::ConditionNode
 {
 public:
     ROS2Condition(const std::string name, const BT::NodeConfiguration& config);
+    ROS2Condition(const std::string name, const BT::NodeConfiguration& config, std::shared_ptr<ROS2SharedNode> sharedNode);
     BT::NodeStatus tick() override;
     int sendTickToSkill();
+    bool canPrefetch();
+    bool prefetch();
+    void setBatchedTick(rclcpp::Client<bt_interfaces_dummy::srv::TickBatch>::SharedFuture future, size_t index);
+    const std::string& host() const;
+    void discardPrefetch();
+    bool consumeTickedFlag();
+    bool getCachedStatus(int8_t& status);
     static BT::PortsList providedPorts();
     bool init();
+    bool isConnected();
     bool stop();
 
 private:
+    bool isInProcess();
+
+    template <typename FutureT>
+    bool waitForResponse(FutureT& future)
+    {
+        if(!m_sharedNode)
+        {
+            return rclcpp::spin_until_future_complete(m_node, future) == rclcpp::FutureReturnCode::SUCCESS;
+        }
+        // the shared node is spun by its own executor, here we only wait
+        while(future.wait_for(std::chrono::seconds(1)) != std::future_status::ready)
+        {
+            if(!rclcpp::ok())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
     std::mutex m_requestMutex;
     rclcpp::Client<bt_interfaces_dummy::srv::TickCondition>::SharedPtr m_clientTick;
     std::shared_ptr<rclcpp::Node> m_node;
+    std::shared_ptr<ROS2SharedNode> m_sharedNode;
     std::string m_name;
     std::string m_suffixMonitor;
+    std::optional<rclcpp::Client<bt_interfaces_dummy::srv::TickCondition>::SharedFutureAndRequestId> m_prefetchedTick;
+    std::shared_ptr<LatencyHistogram> m_tickLatency;
+    std::shared_ptr<TraceRecorder> m_traceRecorder;
+    std::optional<std::pair<rclcpp::Client<bt_interfaces_dummy::srv::TickBatch>::SharedFuture, size_t>> m_batchedTick;
+    std::string m_host;
+    bool m_ticked{false};
+    bool m_isCached{false};
+    std::chrono::milliseconds m_maxAge{1000};
+    rclcpp::Subscription<bt_interfaces_dummy::msg::ConditionResponse>::SharedPtr m_statusSubscription;
+    std::mutex m_cacheMutex;
+    std::optional<int8_t> m_cachedStatus;
+    std::chrono::steady_clock::time_point m_cachedStamp;
 };
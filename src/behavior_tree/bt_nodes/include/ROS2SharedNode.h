@@ -0,0 +1,83 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file ROS2SharedNode.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <rclcpp/rclcpp.hpp>
+#include <TickScheduler.h>
+#include <LatencyMonitor.h>
+#include <TraceRecorder.h>
+#include <HaltCoordinator.h>
+
+/**
+ * Single ROS node, owned by the tree, on which every ROS2Action/ROS2Condition
+ * leaf registers its tick/halt clients. The node is spun by a multi-threaded
+ * executor on a background thread, so the leaves only wait on the futures of
+ * their requests instead of spinning a private node each.
+ * Clients are pooled by service name: leaves talking to the same service,
+ * also across tree reloads, share one already-discovered client.
+ */
+class ROS2SharedNode
+{
+public:
+    ROS2SharedNode(const std::string& name, size_t numberOfThreads = 0);
+    ~ROS2SharedNode();
+    bool start();
+    bool stop();
+    std::shared_ptr<rclcpp::Node> node() const;
+    rclcpp::CallbackGroup::SharedPtr clientCallbackGroup() const;
+    void setTickScheduler(std::shared_ptr<TickScheduler> scheduler);
+    void requestTick();
+    void setLatencyMonitor(std::shared_ptr<LatencyMonitor> monitor);
+    std::shared_ptr<LatencyHistogram> latencyHistogram(const std::string& leaf, const std::string& request) const;
+    void setTraceRecorder(std::shared_ptr<TraceRecorder> recorder);
+    std::shared_ptr<TraceRecorder> traceRecorder() const;
+    std::shared_ptr<HaltCoordinator> haltCoordinator() const;
+    bool watchTopic(const std::string& topic, const std::string& type);
+
+    template <typename ServiceT>
+    typename rclcpp::Client<ServiceT>::SharedPtr client(const std::string& serviceName)
+    {
+        std::lock_guard<std::mutex> lock(m_clientsMutex);
+        auto it = m_clients.find(serviceName);
+        if(it != m_clients.end())
+        {
+            auto pooled = std::dynamic_pointer_cast<rclcpp::Client<ServiceT>>(it->second);
+            if(pooled)
+            {
+                return pooled;
+            }
+        }
+        auto created = m_node->create_client<ServiceT>(serviceName, rclcpp::ServicesQoS(), m_clientCallbackGroup);
+        m_clients[serviceName] = created;
+        return created;
+    }
+
+private:
+    std::shared_ptr<rclcpp::Node> m_node;
+    rclcpp::CallbackGroup::SharedPtr m_clientCallbackGroup;
+    std::shared_ptr<rclcpp::executors::MultiThreadedExecutor> m_executor;
+    std::shared_ptr<std::thread> m_threadSpin;
+    std::shared_ptr<TickScheduler> m_tickScheduler;
+    std::shared_ptr<LatencyMonitor> m_latencyMonitor;
+    std::shared_ptr<TraceRecorder> m_traceRecorder;
+    std::shared_ptr<HaltCoordinator> m_haltCoordinator;
+    std::mutex m_watchedMutex;
+    std::vector<rclcpp::GenericSubscription::SharedPtr> m_watchedSubscriptions;
+    std::mutex m_clientsMutex;
+    std::map<std::string, rclcpp::ClientBase::SharedPtr> m_clients;
+};
@@ -0,0 +1,42 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file ServiceWarmup.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <behaviortree_cpp_v3/bt_factory.h>
+
+/**
+ * Waits for the skills of all the ROS2Action/ROS2Condition leaves of a tree
+ * at once, instead of letting each leaf block on its own service the first
+ * time it is ticked. Discovery of all the services proceeds in parallel and
+ * a single deadline bounds the whole wait.
+ * waitUntilReady() reports the skills still missing at the deadline and then
+ * keeps waiting only for the required ones; with none given it returns at
+ * the deadline and the leaves of the missing skills fail when ticked.
+ */
+class ServiceWarmup
+{
+public:
+    explicit ServiceWarmup(const BT::Tree& tree);
+    std::vector<std::string> waitFor(std::chrono::milliseconds timeout, const std::set<std::string>& skills = {});
+    std::vector<std::string> skills() const;
+    bool waitUntilReady(std::chrono::milliseconds timeout, const std::set<std::string>& required);
+
+private:
+    // leaves with the same name share the skill, one check is enough
+    std::map<std::string, std::function<bool()>> m_isConnected;
+};
@@ -0,0 +1,40 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TickScheduler.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+/**
+ * Decides when the executable ticks the root again: at the latest after the
+ * base period, earlier when someone calls requestTick() (a pending leaf
+ * request completed, a watched topic changed), but never more often than
+ * the minimum interval.
+ */
+class TickScheduler
+{
+public:
+    TickScheduler(std::chrono::milliseconds period, std::chrono::milliseconds minInterval);
+    void requestTick();
+    bool waitForNextTick();
+    void stop();
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::chrono::milliseconds m_period;
+    std::chrono::milliseconds m_minInterval;
+    std::chrono::steady_clock::time_point m_lastTick;
+    bool m_tickRequested{false};
+    bool m_stopped{false};
+};
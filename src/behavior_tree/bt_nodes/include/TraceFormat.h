@@ -0,0 +1,40 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TraceFormat.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Binary trace of the replies received by the leaves, written by
+ * TraceRecorder and read by bt_replay. After the magic and the version the
+ * file is a sequence of records, each starting with its TraceRecord type;
+ * all integers are little endian, timestamps are microseconds since the
+ * beginning of the recording.
+ *   LEAF_NAME      uint16 leaf id, uint16 length, name bytes
+ *   TICK_START     uint64 timestamp
+ *   TICK_RESPONSE  uint64 timestamp, uint16 leaf id, int8 skill status
+ *   HALT           uint64 timestamp, uint16 leaf id
+ * A leaf name is always written before the first record using its id.
+ */
+namespace trace
+{
+    constexpr char MAGIC[4] = {'B', 'T', 'T', 'R'};
+    constexpr uint32_t VERSION = 1;
+
+    enum class TraceRecord : uint8_t
+    {
+        LEAF_NAME = 0,
+        TICK_START = 1,
+        TICK_RESPONSE = 2,
+        HALT = 3
+    };
+}
@@ -0,0 +1,49 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TraceRecorder.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <TraceFormat.h>
+
+/**
+ * Writes the statuses returned by the skills to every tick and every halt
+ * of the leaves in the binary format described in TraceFormat.h, so that a
+ * run can be replayed offline by bt_replay with mock skills.
+ */
+class TraceRecorder
+{
+public:
+    explicit TraceRecorder(const std::string& path);
+    ~TraceRecorder();
+    bool isOpen() const;
+    void beginTick();
+    void recordTick(const std::string& leaf, int8_t status);
+    void recordHalt(const std::string& leaf);
+
+private:
+    uint16_t leafId(const std::string& leaf);
+    uint64_t timestamp() const;
+    template <typename T>
+    void write(T value)
+    {
+        m_file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    std::mutex m_mutex;
+    std::ofstream m_file;
+    std::chrono::steady_clock::time_point m_start;
+    std::map<std::string, uint16_t> m_leafIds;
+};
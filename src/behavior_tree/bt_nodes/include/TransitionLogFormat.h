@@ -0,0 +1,51 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TransitionLogFormat.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Files written by TransitionLogWriter: a fixed-size header followed by
+ * fixed-size transition records, in the order they happened. A log is split
+ * in several files of the same size, ordered by their sequence number; the
+ * node UIDs are the ones BT::Tree assigns when it is created from the XML,
+ * so a converter rebuilds the same tree to get names and types back.
+ */
+namespace transition_log
+{
+    constexpr char MAGIC[4] = {'B', 'T', 'T', 'L'};
+    constexpr uint32_t VERSION = 1;
+    // written when bt_executable_reload swaps the tree, the UIDs after it
+    // refer to the new tree
+    constexpr uint16_t TREE_CHANGED_UID = 0xFFFF;
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t sequence;
+        uint64_t recordCount;
+        uint64_t dropped;
+    };
+
+    struct Record
+    {
+        int64_t timestamp;
+        uint16_t uid;
+        uint8_t previousStatus;
+        uint8_t status;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(FileHeader) == 32, "the header is part of the file format");
+    static_assert(sizeof(Record) == 16, "the record is part of the file format");
+}
@@ -0,0 +1,57 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TransitionLogWriter.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <TransitionLogFormat.h>
+
+/**
+ * Single-producer ring buffer of transition records drained by a background
+ * thread into memory-mapped files of fixed size, <base>.<n>.bttl with n
+ * cycling over maxFiles files. push() never blocks nor allocates: when the
+ * writer falls behind the record is dropped and counted in the file header.
+ * push() must always be called from the same thread, the ticking one.
+ */
+class TransitionLogWriter
+{
+public:
+    TransitionLogWriter(const std::string& basePath, size_t fileSize, size_t maxFiles, size_t ringCapacity = 1 << 16);
+    ~TransitionLogWriter();
+    bool push(const transition_log::Record& record);
+    void stop();
+
+private:
+    void run();
+    void drain();
+    bool openNextFile();
+    void closeFile();
+
+    std::string m_basePath;
+    size_t m_fileSize;
+    size_t m_maxFiles;
+    std::vector<transition_log::Record> m_ring;
+    size_t m_mask;
+    std::atomic<size_t> m_head{0};
+    std::atomic<size_t> m_tail{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<bool> m_running{true};
+    std::shared_ptr<std::thread> m_threadWrite;
+
+    int m_fd{-1};
+    uint8_t* m_map{nullptr};
+    uint64_t m_sequence{0};
+    size_t m_fileCapacity{0};
+};
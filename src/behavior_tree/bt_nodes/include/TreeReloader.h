@@ -0,0 +1,47 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TreeReloader.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <behaviortree_cpp_v3/bt_factory.h>
+
+/**
+ * Builds a new tree on a background thread while the current one keeps
+ * ticking: the file is parsed, the leaves get their clients (from the pool
+ * of the shared node, so services already known are not discovered again)
+ * and the reloader waits until every leaf sees its skill, up to the
+ * discovery timeout. The ticking thread then takes the ready tree between
+ * two ticks with takeReadyTree().
+ */
+class TreeReloader
+{
+public:
+    TreeReloader(BT::BehaviorTreeFactory& factory, std::chrono::milliseconds discoveryTimeout);
+    ~TreeReloader();
+    bool requestReload(const std::string& filePath);
+    std::unique_ptr<BT::Tree> takeReadyTree();
+
+private:
+    void build(const std::string& filePath);
+    bool waitForServices(const BT::Tree& tree);
+
+    BT::BehaviorTreeFactory& m_factory;
+    std::chrono::milliseconds m_discoveryTimeout;
+    std::mutex m_mutex;
+    std::shared_ptr<std::thread> m_threadBuild;
+    bool m_building{false};
+    std::unique_ptr<BT::Tree> m_readyTree;
+};
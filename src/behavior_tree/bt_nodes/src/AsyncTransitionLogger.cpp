@@ -0,0 +1,58 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file AsyncTransitionLogger.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <chrono>
+
+#include <AsyncTransitionLogger.h>
+
+AsyncTransitionLogger::AsyncTransitionLogger(const BT::Tree& tree, std::shared_ptr<TransitionLogWriter> writer, unsigned sampleEvery) :
+        StatusChangeLogger(tree.rootNode()),
+        m_writer(std::move(writer)),
+        m_sampleEvery(sampleEvery == 0 ? 1 : sampleEvery)
+{
+    // the UIDs written from now on belong to this tree
+    transition_log::Record marker{std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count(),
+                                  transition_log::TREE_CHANGED_UID, 0, 0, 0};
+    m_writer->push(marker);
+}
+
+
+void AsyncTransitionLogger::callback(BT::Duration timestamp, const BT::TreeNode& node, BT::NodeStatus prev_status, BT::NodeStatus status)
+{
+    // the decision is taken when the span starts, a node seen for the first
+    // time in the middle of a span starts one too
+    auto span = m_sampledSpans.find(node.UID());
+    if (prev_status == BT::NodeStatus::IDLE || span == m_sampledSpans.end())
+    {
+        bool sampled = ++m_sampleCounter >= m_sampleEvery;
+        if (sampled)
+        {
+            m_sampleCounter = 0;
+        }
+        span = m_sampledSpans.insert_or_assign(node.UID(), sampled).first;
+    }
+    if (!span->second)
+    {
+        return;
+    }
+    transition_log::Record record{std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp).count(),
+                                  node.UID(),
+                                  static_cast<uint8_t>(prev_status),
+                                  static_cast<uint8_t>(status),
+                                  0};
+    m_writer->push(record);
+}
+
+
+void AsyncTransitionLogger::flush()
+{
+    // the writer thread drains continuously, there is nothing to force here
+}
@@ -0,0 +1,124 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file ConditionPrefetcher.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <ConditionPrefetcher.h>
+
+ConditionPrefetcher::ConditionPrefetcher(std::shared_ptr<ROS2SharedNode> sharedNode) :
+        m_sharedNode(std::move(sharedNode))
+{
+}
+
+
+ConditionPrefetcher::ConditionPrefetcher(const BT::Tree& tree, std::shared_ptr<ROS2SharedNode> sharedNode) :
+        m_sharedNode(std::move(sharedNode))
+{
+    setTree(tree);
+}
+
+
+// the node below node through a chain of decorators, if any
+static BT::TreeNode* undecorated(BT::TreeNode* node)
+{
+    while (auto decorator = dynamic_cast<BT::DecoratorNode*>(node))
+    {
+        node = decorator->child();
+    }
+    return node;
+}
+
+
+void ConditionPrefetcher::setTree(const BT::Tree& tree)
+{
+    m_conditions.clear();
+    // only the root is ticked before any action of the tree: the leading
+    // conditions of a nested Reactive node come after whatever was ticked
+    // ahead of it in the traversal, and may sit on a branch not reached at all
+    BT::TreeNode* root = undecorated(tree.rootNode());
+    if (dynamic_cast<BT::ReactiveSequence*>(root) == nullptr &&
+        dynamic_cast<BT::ReactiveFallback*>(root) == nullptr)
+    {
+        return;
+    }
+    for (BT::TreeNode* child : static_cast<BT::ControlNode*>(root)->children())
+    {
+        auto condition = dynamic_cast<ROS2Condition*>(undecorated(child));
+        if (condition == nullptr)
+        {
+            break;
+        }
+        m_conditions.push_back({condition, false});
+    }
+}
+
+
+void ConditionPrefetcher::beforeTick()
+{
+    std::map<std::string, std::vector<ROS2Condition*>> batches;
+    for (Entry& entry : m_conditions)
+    {
+        if (!entry.tickedLastTime)
+        {
+            continue;
+        }
+        if (m_sharedNode && !entry.condition->host().empty())
+        {
+            if (entry.condition->canPrefetch())
+            {
+                batches[entry.condition->host()].push_back(entry.condition);
+            }
+        }
+        else
+        {
+            entry.condition->prefetch();
+        }
+    }
+
+    for (auto& [host, conditions] : batches)
+    {
+        auto client = m_sharedNode->client<bt_interfaces_dummy::srv::TickBatch>(host + "/TickBatch");
+        if (!client->service_is_ready())
+        {
+            for (ROS2Condition* condition : conditions)
+            {
+                condition->prefetch();
+            }
+            continue;
+        }
+        auto request = std::make_shared<bt_interfaces_dummy::srv::TickBatch::Request>();
+        for (ROS2Condition* condition : conditions)
+        {
+            request->skills.push_back(condition->name());
+        }
+        auto future = client->async_send_request(request,
+            [histogram = m_sharedNode->latencyHistogram(host, "batch"), sent = std::chrono::steady_clock::now()](rclcpp::Client<bt_interfaces_dummy::srv::TickBatch>::SharedFuture)
+            {
+                if (histogram)
+                {
+                    histogram->recordSince(sent);
+                }
+            }).future;
+        for (size_t i = 0; i < conditions.size(); ++i)
+        {
+            conditions[i]->setBatchedTick(future, i);
+        }
+    }
+}
+
+
+void ConditionPrefetcher::afterTick()
+{
+    for (Entry& entry : m_conditions)
+    {
+        // replies of conditions that were not reached are dropped, they must not be used in the next tick
+        entry.condition->discardPrefetch();
+        entry.tickedLastTime = entry.condition->consumeTickedFlag();
+    }
+}
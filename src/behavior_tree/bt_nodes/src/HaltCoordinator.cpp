@@ -0,0 +1,88 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file HaltCoordinator.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <thread>
+
+#include <rclcpp/rclcpp.hpp>
+#include <HaltCoordinator.h>
+
+void HaltCoordinator::add(const void* owner, const std::string& leaf, Poll poll)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending[owner] = PendingHalt{leaf, std::move(poll)};
+}
+
+
+void HaltCoordinator::remove(const void* owner)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.erase(owner);
+}
+
+
+bool HaltCoordinator::isPending(const void* owner)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending.count(owner) > 0;
+}
+
+
+std::vector<std::string> HaltCoordinator::awaitPending(std::chrono::milliseconds pollPeriod)
+{
+    std::vector<std::string> failed;
+    while (rclcpp::ok())
+    {
+        std::map<const void*, PendingHalt> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            pending = m_pending;
+        }
+        if (pending.empty())
+        {
+            break;
+        }
+        // the poll functions are called without the lock, a leaf may send a
+        // retry or remove itself from inside them
+        bool stillPending = false;
+        for (auto& [owner, halt] : pending)
+        {
+            auto state = halt.poll();
+            if (state == HaltState::PENDING)
+            {
+                stillPending = true;
+                continue;
+            }
+            if (state == HaltState::FAILED)
+            {
+                RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Node %s could not be halted within its deadline and retries", halt.leaf.c_str());
+                failed.push_back(halt.leaf);
+                m_failed++;
+            }
+            remove(owner);
+        }
+        if (!stillPending)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(pollPeriod);
+    }
+    if (!failed.empty())
+    {
+        RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "%zu leaves failed to halt, %zu since start", failed.size(), m_failed.load());
+    }
+    return failed;
+}
+
+
+size_t HaltCoordinator::failedCount() const
+{
+    return m_failed.load();
+}
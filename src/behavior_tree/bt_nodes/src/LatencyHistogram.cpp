@@ -0,0 +1,98 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file LatencyHistogram.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <LatencyHistogram.h>
+
+unsigned LatencyHistogram::bucketIndex(uint64_t value)
+{
+    value = std::min<uint64_t>(value, (uint64_t(1) << (MAX_MSB + 1)) - 1);
+    if (value < SUB_BUCKETS)
+    {
+        return static_cast<unsigned>(value);
+    }
+    unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+    unsigned magnitude = msb - SUB_BUCKET_BITS + 1;
+    unsigned sub = static_cast<unsigned>(value >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return magnitude * SUB_BUCKETS + sub;
+}
+
+
+uint64_t LatencyHistogram::bucketUpperBound(unsigned index)
+{
+    if (index < SUB_BUCKETS)
+    {
+        return index;
+    }
+    unsigned magnitude = index / SUB_BUCKETS;
+    unsigned sub = index % SUB_BUCKETS;
+    unsigned shift = magnitude - 1;
+    return ((uint64_t(SUB_BUCKETS + sub) << shift) + (uint64_t(1) << shift)) - 1;
+}
+
+
+void LatencyHistogram::record(uint64_t microseconds)
+{
+    m_buckets[bucketIndex(microseconds)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    uint64_t current = m_max.load(std::memory_order_relaxed);
+    while (microseconds > current && !m_max.compare_exchange_weak(current, microseconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+
+void LatencyHistogram::recordSince(std::chrono::steady_clock::time_point start)
+{
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    record(static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0)));
+}
+
+
+uint64_t LatencyHistogram::count() const
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::max() const
+{
+    return m_max.load(std::memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::percentile(double percent) const
+{
+    // the buckets are read one by one while other threads record, the result
+    // may mix two consecutive states, which is fine for monitoring
+    uint64_t total = 0;
+    for (const auto& bucket : m_buckets)
+    {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percent / 100.0 * total)));
+    uint64_t cumulated = 0;
+    for (unsigned i = 0; i < BUCKETS; ++i)
+    {
+        cumulated += m_buckets[i].load(std::memory_order_relaxed);
+        if (cumulated >= target)
+        {
+            return std::min(bucketUpperBound(i), max());
+        }
+    }
+    return max();
+}
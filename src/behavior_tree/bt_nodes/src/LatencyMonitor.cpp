@@ -0,0 +1,94 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file LatencyMonitor.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <fstream>
+
+#include <LatencyMonitor.h>
+
+std::shared_ptr<LatencyHistogram> LatencyMonitor::histogram(const std::string& leaf, const std::string& request)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // leaves with the same name talk to the same skill and share the histogram
+    auto& histogram = m_histograms[{leaf, request}];
+    if (!histogram)
+    {
+        histogram = std::make_shared<LatencyHistogram>();
+    }
+    return histogram;
+}
+
+
+void LatencyMonitor::startPublishing(std::shared_ptr<rclcpp::Node> node, const std::string& topic, std::chrono::milliseconds period)
+{
+    m_publisher = node->create_publisher<bt_interfaces_dummy::msg::LeafLatencyArray>(topic, 10);
+    m_timer = node->create_wall_timer(period, [this]() { publish(); });
+}
+
+
+bt_interfaces_dummy::msg::LeafLatencyArray LatencyMonitor::summary()
+{
+    bt_interfaces_dummy::msg::LeafLatencyArray msg;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& [key, histogram] : m_histograms)
+    {
+        if (histogram->count() == 0)
+        {
+            continue;
+        }
+        bt_interfaces_dummy::msg::LeafLatency leaf;
+        leaf.leaf = key.first;
+        leaf.request = key.second;
+        leaf.count = histogram->count();
+        leaf.p50_us = histogram->percentile(50);
+        leaf.p95_us = histogram->percentile(95);
+        leaf.p99_us = histogram->percentile(99);
+        leaf.max_us = histogram->max();
+        msg.leaves.push_back(leaf);
+    }
+    return msg;
+}
+
+
+void LatencyMonitor::publish()
+{
+    if (m_publisher)
+    {
+        m_publisher->publish(summary());
+    }
+}
+
+
+bool LatencyMonitor::dumpJson(const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Cannot write the latency summary to %s", path.c_str());
+        return false;
+    }
+    // leaf names are BT node names, they never need escaping
+    auto msg = summary();
+    file << "{\n  \"leaves\": [";
+    for (size_t i = 0; i < msg.leaves.size(); ++i)
+    {
+        const auto& leaf = msg.leaves[i];
+        file << (i == 0 ? "\n" : ",\n")
+             << "    {\"leaf\": \"" << leaf.leaf << "\", \"request\": \"" << leaf.request
+             << "\", \"count\": " << leaf.count
+             << ", \"p50_us\": " << leaf.p50_us
+             << ", \"p95_us\": " << leaf.p95_us
+             << ", \"p99_us\": " << leaf.p99_us
+             << ", \"max_us\": " << leaf.max_us << "}";
+    }
+    file << "\n  ]\n}\n";
+    RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Latency summary written to %s", path.c_str());
+    return true;
+}
@@ -14,7 +14,14 @@
 #include <ROS2Action.h>
 
 ROS2Action::ROS2Action(const std::string name, const BT::NodeConfiguration& config) :
-        ActionNodeBase(name, config)
+        ROS2Action(name, config, nullptr)
+{
+}
+
+
+ROS2Action::ROS2Action(const std::string name, const BT::NodeConfiguration& config, std::shared_ptr<ROS2SharedNode> sharedNode) :
+        ActionNodeBase(name, config),
+        m_sharedNode(std::move(sharedNode))
 {
 
     BT::Optional<std::string> is_monitored = BT::TreeNode::getInput<std::string>("isMonitored");
@@ -22,6 +29,26 @@ ROS2Action::ROS2Action(const std::string name, const BT::NodeConfiguration& conf
     {
         m_suffixMonitor = "_mon";
     }
+    BT::Optional<std::string> is_async = BT::TreeNode::getInput<std::string>("isAsync");
+    if (is_async && is_async.value() == "true")
+    {
+        m_isAsync = true;
+    }
+    BT::Optional<unsigned> deadline = BT::TreeNode::getInput<unsigned>("deadlineMs");
+    if (deadline)
+    {
+        m_deadline = std::chrono::milliseconds(deadline.value());
+    }
+    BT::Optional<unsigned> halt_deadline = BT::TreeNode::getInput<unsigned>("haltDeadlineMs");
+    if (halt_deadline)
+    {
+        m_haltDeadline = std::chrono::milliseconds(halt_deadline.value());
+    }
+    BT::Optional<unsigned> halt_retries = BT::TreeNode::getInput<unsigned>("haltRetries");
+    if (halt_retries)
+    {
+        m_haltRetries = halt_retries.value();
+    }
     BT::Optional<std::string> interface = BT::TreeNode::getInput<std::string>("interface");
     bool ok = init();
 
@@ -32,6 +59,30 @@ ROS2Action::ROS2Action(const std::string name, const BT::NodeConfiguration& conf
 }
 
 
+ROS2Action::~ROS2Action()
+{
+    if (m_sharedNode)
+    {
+        m_sharedNode->haltCoordinator()->remove(this);
+    }
+    cancelPendingHalt();
+}
+
+
+bool ROS2Action::isInProcess()
+{
+    // skill plugins loaded in this process are called directly, unless the
+    // leaf is monitored: the monitor only sees the ROS services
+    return m_suffixMonitor.empty() && SkillTickRegistry::instance().contains(ActionNodeBase::name());
+}
+
+
+bool ROS2Action::isConnected()
+{
+    return isInProcess() || m_clientTick->service_is_ready();
+}
+
+
 int ROS2Action::sendTickToSkill() 
 {
     auto msg = bt_interfaces_dummy::msg::ActionResponse();
@@ -44,22 +95,110 @@ int ROS2Action::sendTickToSkill()
         }
         RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "service TickAction in %s not available, waiting again...", ActionNodeBase::name().c_str());
     }
-    auto result = m_clientTick->async_send_request(request);
+    auto result = m_clientTick->async_send_request(request,
+        [histogram = m_tickLatency, sent = std::chrono::steady_clock::now()](rclcpp::Client<bt_interfaces_dummy::srv::TickAction>::SharedFuture)
+        {
+            if (histogram)
+            {
+                histogram->recordSince(sent);
+            }
+        });
     std::this_thread::sleep_for (std::chrono::milliseconds(100));
-    if (rclcpp::spin_until_future_complete(m_node, result) ==
-        rclcpp::FutureReturnCode::SUCCESS) {
+    if (waitForResponse(result)) {
         return result.get()->status;
     }
     return msg.SKILL_FAILURE;
 }
 
 
+int ROS2Action::sendAsyncTickToSkill()
+{
+    auto msg = bt_interfaces_dummy::msg::ActionResponse();
+    auto now = std::chrono::steady_clock::now();
+    if (!m_pendingSince)
+    {
+        m_pendingSince = now;
+    }
+    if (!m_pendingTick)
+    {
+        if (!m_clientTick->service_is_ready())
+        {
+            if (m_deadline.count() > 0 && now - *m_pendingSince > m_deadline)
+            {
+                RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "service TickAction in %s not available before the deadline", ActionNodeBase::name().c_str());
+                m_pendingSince.reset();
+                return msg.SKILL_FAILURE;
+            }
+            RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "service TickAction in %s not available, trying again at next tick...", ActionNodeBase::name().c_str());
+            return msg.SKILL_RUNNING;
+        }
+        RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "sending async tick to  %s ", ActionNodeBase::name().c_str());
+        auto request = std::make_shared<bt_interfaces_dummy::srv::TickAction::Request>();
+        // the reply wakes up the tick scheduler, so the tree reacts without waiting for the next period
+        m_pendingTick.emplace(m_clientTick->async_send_request(request,
+            [sharedNode = m_sharedNode, histogram = m_tickLatency, sent = now](rclcpp::Client<bt_interfaces_dummy::srv::TickAction>::SharedFuture)
+            {
+                if (histogram)
+                {
+                    histogram->recordSince(sent);
+                }
+                if (sharedNode)
+                {
+                    sharedNode->requestTick();
+                }
+            }));
+    }
+    if (isResponseReady(*m_pendingTick))
+    {
+        auto status = m_pendingTick->get()->status;
+        m_pendingTick.reset();
+        m_pendingSince.reset();
+        return status;
+    }
+    if (m_deadline.count() > 0 && now - *m_pendingSince > m_deadline)
+    {
+        RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Node %s: skill did not reply to the tick before the deadline", ActionNodeBase::name().c_str());
+        cancelPendingTick();
+        return msg.SKILL_FAILURE;
+    }
+    return msg.SKILL_RUNNING;
+}
+
+
+void ROS2Action::cancelPendingTick()
+{
+    if (m_pendingTick)
+    {
+        m_clientTick->remove_pending_request(*m_pendingTick);
+        m_pendingTick.reset();
+    }
+    m_pendingSince.reset();
+}
+
+
 BT::NodeStatus ROS2Action::tick()
 {
     std::lock_guard<std::mutex> lock(m_requestMutex);
+    finishPendingHalt();
     auto message = bt_interfaces_dummy::msg::ActionResponse();
     RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Node %s sending tick to skill", ActionNodeBase::name().c_str());
-    auto status = sendTickToSkill();
+    int8_t status;
+    auto started = std::chrono::steady_clock::now();
+    if (isInProcess() && SkillTickRegistry::instance().tick(ActionNodeBase::name(), status))
+    {
+        if (m_tickLatency)
+        {
+            m_tickLatency->recordSince(started);
+        }
+    }
+    else
+    {
+        status = m_isAsync ? sendAsyncTickToSkill() : sendTickToSkill();
+    }
+    if (m_traceRecorder)
+    {
+        m_traceRecorder->recordTick(ActionNodeBase::name(), status);
+    }
     switch (status) {
         case message.SKILL_RUNNING:
             return BT::NodeStatus::RUNNING;
@@ -78,30 +217,157 @@ BT::NodeStatus ROS2Action::tick()
 BT::PortsList ROS2Action::providedPorts()
 {
     return { BT::InputPort<std::string>("interface"),
-             BT::InputPort<std::string>("isMonitored")  };
+             BT::InputPort<std::string>("isMonitored"),
+             BT::InputPort<std::string>("isAsync", "false", "send the tick without waiting and poll the reply at the following ticks"),
+             BT::InputPort<unsigned>("deadlineMs", 0, "async mode only: fail if the skill does not reply within this time, 0 disables it"),
+             BT::InputPort<unsigned>("haltDeadlineMs", 1000, "time given to the skill to acknowledge each halt attempt, 0 waits forever"),
+             BT::InputPort<unsigned>("haltRetries", 2, "halt attempts sent again after the first one expires, then the leaf is reported as not halted")  };
 }
 
 void ROS2Action::halt()
 {        
     RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Node %s sending halt to skill@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@", ActionNodeBase::name().c_str());
 
-    bool success = false;
-    do {
-        RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Node %s sending halt to skill", ActionNodeBase::name().c_str());
-        auto request = std::make_shared<bt_interfaces_dummy::srv::HaltAction::Request>();
-        while (!m_clientHalt->wait_for_service(std::chrono::seconds(1))) {
-            if (!rclcpp::ok()) {
-            RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Interrupted while waiting for the service TickAction. Exiting.");
+    {
+        std::lock_guard<std::mutex> lock(m_requestMutex);
+        // an outstanding async tick is dropped, its reply would be stale after the halt
+        cancelPendingTick();
+    }
+    if (m_traceRecorder)
+    {
+        m_traceRecorder->recordHalt(ActionNodeBase::name());
+    }
+    auto started = std::chrono::steady_clock::now();
+    if (isInProcess() && SkillTickRegistry::instance().halt(ActionNodeBase::name()))
+    {
+        if (m_haltLatency)
+        {
+            m_haltLatency->recordSince(started);
+        }
+        return;
+    }
+    m_haltAttempts = 0;
+    startHaltAttempt();
+    if (m_sharedNode)
+    {
+        // only sent here: the halts of the siblings preempted in the same tick
+        // are in flight together and the executable awaits them after the tick
+        m_sharedNode->haltCoordinator()->add(this, ActionNodeBase::name(), [this]() { return pollHalt(); });
+        return;
+    }
+    waitForHalt();
+}
+
+
+bool ROS2Action::sendHaltToSkill()
+{
+    m_haltTriedAt = std::chrono::steady_clock::now();
+    if (!m_clientHalt->service_is_ready())
+    {
+        RCLCPP_DEBUG(rclcpp::get_logger("rclcpp"), "%s service HaltAction not available, trying again...", ActionNodeBase::name().c_str());
+        return false;
+    }
+    RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Node %s sending halt to skill", ActionNodeBase::name().c_str());
+    auto request = std::make_shared<bt_interfaces_dummy::srv::HaltAction::Request>();
+    m_pendingHalt.emplace(m_clientHalt->async_send_request(request,
+        [histogram = m_haltLatency, sent = std::chrono::steady_clock::now()](rclcpp::Client<bt_interfaces_dummy::srv::HaltAction>::SharedFuture)
+        {
+            if (histogram)
+            {
+                histogram->recordSince(sent);
             }
-            RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "%s service TickAction not available, waiting again...", ActionNodeBase::name().c_str());
+        }));
+    return true;
+}
+
+
+void ROS2Action::startHaltAttempt()
+{
+    cancelPendingHalt();
+    m_haltAttempts++;
+    m_haltSince = std::chrono::steady_clock::now();
+    sendHaltToSkill();
+}
+
+
+HaltCoordinator::HaltState ROS2Action::pollHalt()
+{
+    auto now = std::chrono::steady_clock::now();
+    bool expired = m_haltDeadline.count() > 0 && now - m_haltSince > m_haltDeadline;
+    if (m_pendingHalt && isResponseReady(*m_pendingHalt))
+    {
+        bool is_ok = m_pendingHalt->get()->is_ok;
+        m_pendingHalt.reset();
+        if (is_ok)
+        {
+            return HaltCoordinator::HaltState::DONE;
         }
-        auto result = m_clientHalt->async_send_request(request);
-        // std::this_thread::sleep_for (std::chrono::milliseconds(100));
-        if (rclcpp::spin_until_future_complete(m_node, result) ==
-            rclcpp::FutureReturnCode::SUCCESS) {
-            success = true;
+        RCLCPP_WARN(rclcpp::get_logger("rclcpp"), "Node %s: skill refused the halt (attempt %u)", ActionNodeBase::name().c_str(), m_haltAttempts);
+    }
+    else if (!expired)
+    {
+        // the service was not available, it is looked up again at a slower pace than the polls
+        if (!m_pendingHalt && now - m_haltTriedAt >= HALT_RETRY_PERIOD)
+        {
+            sendHaltToSkill();
         }
-    } while (!success);
+        return HaltCoordinator::HaltState::PENDING;
+    }
+    else
+    {
+        RCLCPP_WARN(rclcpp::get_logger("rclcpp"), "Node %s: skill did not acknowledge the halt before the deadline (attempt %u)", ActionNodeBase::name().c_str(), m_haltAttempts);
+        cancelPendingHalt();
+    }
+    if (m_haltAttempts > m_haltRetries)
+    {
+        return HaltCoordinator::HaltState::FAILED;
+    }
+    startHaltAttempt();
+    return HaltCoordinator::HaltState::PENDING;
+}
+
+
+bool ROS2Action::waitForHalt()
+{
+    while (rclcpp::ok())
+    {
+        auto state = pollHalt();
+        if (state == HaltCoordinator::HaltState::DONE)
+        {
+            return true;
+        }
+        if (state == HaltCoordinator::HaltState::FAILED)
+        {
+            RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Node %s could not be halted within its deadline and retries", ActionNodeBase::name().c_str());
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    cancelPendingHalt();
+    return false;
+}
+
+
+void ROS2Action::finishPendingHalt()
+{
+    // ticked again in the same traversal it was halted in: the skill must get
+    // the halt before the new tick
+    if (!m_sharedNode || !m_sharedNode->haltCoordinator()->isPending(this))
+    {
+        return;
+    }
+    waitForHalt();
+    m_sharedNode->haltCoordinator()->remove(this);
+}
+
+
+void ROS2Action::cancelPendingHalt()
+{
+    if (m_pendingHalt)
+    {
+        m_clientHalt->remove_pending_request(*m_pendingHalt);
+        m_pendingHalt.reset();
+    }
 }
 
 
@@ -109,14 +375,26 @@ void ROS2Action::halt()
 bool ROS2Action::init()
 {
 
-    if(!rclcpp::ok())
+    if(m_sharedNode)
     {
-        rclcpp::init(/*argc*/ 0, /*argv*/ nullptr);
+        m_node = m_sharedNode->node();
+        m_clientTick = m_sharedNode->client<bt_interfaces_dummy::srv::TickAction>(ActionNodeBase::name() + "Skill/tick" + m_suffixMonitor);
+        m_clientHalt = m_sharedNode->client<bt_interfaces_dummy::srv::HaltAction>(ActionNodeBase::name() + "Skill/halt" + m_suffixMonitor);
+        m_tickLatency = m_sharedNode->latencyHistogram(ActionNodeBase::name(), "tick");
+        m_haltLatency = m_sharedNode->latencyHistogram(ActionNodeBase::name(), "halt");
+        m_traceRecorder = m_sharedNode->traceRecorder();
     }
+    else
+    {
+        if(!rclcpp::ok())
+        {
+            rclcpp::init(/*argc*/ 0, /*argv*/ nullptr);
+        }
 
-    m_node = rclcpp::Node::make_shared(ActionNodeBase::name()+ "ActionLeaf");
-    m_clientTick = m_node->create_client<bt_interfaces_dummy::srv::TickAction>(ActionNodeBase::name() + "Skill/tick" + m_suffixMonitor);
-    m_clientHalt = m_node->create_client<bt_interfaces_dummy::srv::HaltAction>(ActionNodeBase::name() + "Skill/halt" + m_suffixMonitor);
+        m_node = rclcpp::Node::make_shared(ActionNodeBase::name()+ "ActionLeaf");
+        m_clientTick = m_node->create_client<bt_interfaces_dummy::srv::TickAction>(ActionNodeBase::name() + "Skill/tick" + m_suffixMonitor);
+        m_clientHalt = m_node->create_client<bt_interfaces_dummy::srv::HaltAction>(ActionNodeBase::name() + "Skill/halt" + m_suffixMonitor);
+    }
     RCLCPP_INFO_STREAM(rclcpp::get_logger("rclcpp"),"name -- " << ActionNodeBase::name() << " -- suffixmonitor " << m_suffixMonitor);
     
     return true;
@@ -14,7 +14,14 @@
 #include <ROS2Condition.h>
 
 ROS2Condition::ROS2Condition(const std::string name, const BT::NodeConfiguration& config) :
-        ConditionNode(name, config)
+        ROS2Condition(name, config, nullptr)
+{
+}
+
+
+ROS2Condition::ROS2Condition(const std::string name, const BT::NodeConfiguration& config, std::shared_ptr<ROS2SharedNode> sharedNode) :
+        ConditionNode(name, config),
+        m_sharedNode(std::move(sharedNode))
 {
     BT::Optional<std::string> is_monitored = BT::TreeNode::getInput<std::string>("isMonitored");
     if (is_monitored.value() == "true")
@@ -22,7 +29,23 @@ ROS2Condition::ROS2Condition(const std::string name, const BT::NodeConfiguration
         m_suffixMonitor = "_mon";
     }
 
-    
+    BT::Optional<std::string> is_cached = BT::TreeNode::getInput<std::string>("isCached");
+    if (is_cached && is_cached.value() == "true")
+    {
+        m_isCached = true;
+    }
+    BT::Optional<unsigned> max_age = BT::TreeNode::getInput<unsigned>("maxAgeMs");
+    if (max_age)
+    {
+        m_maxAge = std::chrono::milliseconds(max_age.value());
+    }
+
+    BT::Optional<std::string> host = BT::TreeNode::getInput<std::string>("host");
+    if (host)
+    {
+        m_host = host.value();
+    }
+
     BT::Optional<std::string> interface = BT::TreeNode::getInput<std::string>("interface");
     bool ok = init();
     if(!ok)
@@ -34,20 +57,60 @@ ROS2Condition::ROS2Condition(const std::string name, const BT::NodeConfiguration
 BT::PortsList ROS2Condition::providedPorts()
 {
     return { BT::InputPort<std::string>("interface"),
-             BT::InputPort<std::string>("isMonitored") };
+             BT::InputPort<std::string>("isMonitored"),
+             BT::InputPort<std::string>("isCached", "false", "return the last value published by the skill on its status topic"),
+             BT::InputPort<unsigned>("maxAgeMs", 1000, "cached mode only: older values are refreshed with a synchronous tick"),
+             BT::InputPort<std::string>("host", "", "process hosting the skill, conditions on the same host are prefetched with one TickBatch request") };
 }
 
 
 bool ROS2Condition::init()
 {
 
-    if(!rclcpp::ok())
+    if(m_sharedNode)
     {
-        rclcpp::init(/*argc*/ 0, /*argv*/ nullptr);
+        m_node = m_sharedNode->node();
+        m_clientTick = m_sharedNode->client<bt_interfaces_dummy::srv::TickCondition>(ConditionNode::name() + "Skill/tick" + m_suffixMonitor);
+        m_tickLatency = m_sharedNode->latencyHistogram(ConditionNode::name(), "tick");
+        m_traceRecorder = m_sharedNode->traceRecorder();
+        if (m_isCached)
+        {
+            rclcpp::SubscriptionOptions options;
+            options.callback_group = m_sharedNode->clientCallbackGroup();
+            m_statusSubscription = m_node->create_subscription<bt_interfaces_dummy::msg::ConditionResponse>(ConditionNode::name() + "Skill/status",
+                rclcpp::QoS(1).transient_local(),
+                [this](const bt_interfaces_dummy::msg::ConditionResponse::SharedPtr msg)
+                {
+                    bool changed;
+                    {
+                        std::lock_guard<std::mutex> lock(m_cacheMutex);
+                        changed = !m_cachedStatus || *m_cachedStatus != msg->status;
+                        m_cachedStatus = msg->status;
+                        m_cachedStamp = std::chrono::steady_clock::now();
+                    }
+                    if (changed)
+                    {
+                        m_sharedNode->requestTick();
+                    }
+                },
+                options);
+        }
     }
+    else
+    {
+        if (m_isCached)
+        {
+            RCLCPP_WARN(rclcpp::get_logger("rclcpp"), "%s: isCached needs the shared leaf node, the skill will be ticked every time", ConditionNode::name().c_str());
+            m_isCached = false;
+        }
+        if(!rclcpp::ok())
+        {
+            rclcpp::init(/*argc*/ 0, /*argv*/ nullptr);
+        }
 
-    m_node = rclcpp::Node::make_shared(ConditionNode::name()+ "ConditionLeaf");
-    m_clientTick = m_node->create_client<bt_interfaces_dummy::srv::TickCondition>(ConditionNode::name() + "Skill/tick" + m_suffixMonitor);
+        m_node = rclcpp::Node::make_shared(ConditionNode::name()+ "ConditionLeaf");
+        m_clientTick = m_node->create_client<bt_interfaces_dummy::srv::TickCondition>(ConditionNode::name() + "Skill/tick" + m_suffixMonitor);
+    }
     RCLCPP_INFO_STREAM(rclcpp::get_logger("rclcpp"),"name -- " << ConditionNode::name() << " -- suffixmonitor " << m_suffixMonitor);
     
     return true;
@@ -63,10 +126,57 @@ bool ROS2Condition::stop()
 
 
 
+bool ROS2Condition::isInProcess()
+{
+    // skill plugins loaded in this process are called directly, unless the
+    // leaf is monitored: the monitor only sees the ROS services
+    return m_suffixMonitor.empty() && SkillTickRegistry::instance().contains(ConditionNode::name());
+}
+
+
+bool ROS2Condition::isConnected()
+{
+    return isInProcess() || m_clientTick->service_is_ready();
+}
+
+
 int ROS2Condition::sendTickToSkill() 
 {
     std::lock_guard<std::mutex> lock(m_requestMutex);
     auto msg = bt_interfaces_dummy::msg::ConditionResponse();
+    int8_t status;
+    auto started = std::chrono::steady_clock::now();
+    if (isInProcess() && SkillTickRegistry::instance().tick(ConditionNode::name(), status))
+    {
+        if (m_tickLatency)
+        {
+            m_tickLatency->recordSince(started);
+        }
+        return status;
+    }
+    if (m_batchedTick)
+    {
+        auto batched = std::move(*m_batchedTick);
+        m_batchedTick.reset();
+        if (waitForResponse(batched.first)) {
+            auto response = batched.first.get();
+            if (batched.second < response->statuses.size() && batched.second < response->is_ok.size() && response->is_ok[batched.second]) {
+                return response->statuses[batched.second];
+            }
+        }
+        // the host could not tick this skill, ask the skill directly
+        RCLCPP_WARN(rclcpp::get_logger("rclcpp"), "%s not ticked by the TickBatch of host %s", ConditionNode::name().c_str(), m_host.c_str());
+    }
+    else if (m_prefetchedTick)
+    {
+        // the request was already sent at the beginning of this tick
+        auto prefetched = std::move(*m_prefetchedTick);
+        m_prefetchedTick.reset();
+        if (waitForResponse(prefetched)) {
+            return prefetched.get()->status;
+        }
+        return msg.SKILL_FAILURE;
+    }
     auto request = std::make_shared<bt_interfaces_dummy::srv::TickCondition::Request>();
     while (!m_clientTick->wait_for_service(std::chrono::seconds(1))) {
         if (!rclcpp::ok()) {
@@ -75,21 +185,138 @@ int ROS2Condition::sendTickToSkill()
         }
         RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "%s service TickCondition not available, waiting again...", ConditionNode::name().c_str());
     }
-    auto result = m_clientTick->async_send_request(request);
+    auto result = m_clientTick->async_send_request(request,
+        [histogram = m_tickLatency, sent = std::chrono::steady_clock::now()](rclcpp::Client<bt_interfaces_dummy::srv::TickCondition>::SharedFuture)
+        {
+            if (histogram)
+            {
+                histogram->recordSince(sent);
+            }
+        });
     // std::this_thread::sleep_for (std::chrono::milliseconds(100));
-    if (rclcpp::spin_until_future_complete(m_node, result) ==
-        rclcpp::FutureReturnCode::SUCCESS) {
+    if (waitForResponse(result)) {
         return result.get()->status;
     }
     return msg.SKILL_FAILURE;
 }
 
 
+bool ROS2Condition::getCachedStatus(int8_t& status)
+{
+    if (!m_isCached)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_cacheMutex);
+    if (!m_cachedStatus || std::chrono::steady_clock::now() - m_cachedStamp > m_maxAge)
+    {
+        return false;
+    }
+    status = *m_cachedStatus;
+    return true;
+}
+
+
+bool ROS2Condition::canPrefetch()
+{
+    int8_t cached;
+    if (getCachedStatus(cached))
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_requestMutex);
+    // without the shared node nobody would spin the reply while the tree is traversed,
+    // a skill in this process answers faster than any prefetched request
+    return m_sharedNode && !m_prefetchedTick && !m_batchedTick && !isInProcess();
+}
+
+
+bool ROS2Condition::prefetch()
+{
+    if (!canPrefetch())
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_requestMutex);
+    if (!m_clientTick->service_is_ready())
+    {
+        return false;
+    }
+    auto request = std::make_shared<bt_interfaces_dummy::srv::TickCondition::Request>();
+    m_prefetchedTick.emplace(m_clientTick->async_send_request(request,
+        [histogram = m_tickLatency, sent = std::chrono::steady_clock::now()](rclcpp::Client<bt_interfaces_dummy::srv::TickCondition>::SharedFuture)
+        {
+            if (histogram)
+            {
+                histogram->recordSince(sent);
+            }
+        }));
+    return true;
+}
+
+
+void ROS2Condition::setBatchedTick(rclcpp::Client<bt_interfaces_dummy::srv::TickBatch>::SharedFuture future, size_t index)
+{
+    std::lock_guard<std::mutex> lock(m_requestMutex);
+    m_batchedTick.emplace(std::move(future), index);
+}
+
+
+const std::string& ROS2Condition::host() const
+{
+    // the monitor proxies only the per-skill services, monitored conditions are never batched
+    static const std::string noHost;
+    return m_suffixMonitor.empty() ? m_host : noHost;
+}
+
+
+void ROS2Condition::discardPrefetch()
+{
+    std::lock_guard<std::mutex> lock(m_requestMutex);
+    // the batch request belongs to the prefetcher, only our share of it is dropped
+    m_batchedTick.reset();
+    if (m_prefetchedTick)
+    {
+        m_clientTick->remove_pending_request(*m_prefetchedTick);
+        m_prefetchedTick.reset();
+    }
+}
+
+
+bool ROS2Condition::consumeTickedFlag()
+{
+    bool ticked = m_ticked;
+    m_ticked = false;
+    return ticked;
+}
+
+
 BT::NodeStatus ROS2Condition::tick()
 {
+    m_ticked = true;
     auto message = bt_interfaces_dummy::msg::ConditionResponse();
-    RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Node %s sending tick to skill", ConditionNode::name().c_str());
-    auto status = sendTickToSkill();
+    int8_t cached;
+    int status;
+    if (getCachedStatus(cached))
+    {
+        status = cached;
+    }
+    else
+    {
+        RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Node %s sending tick to skill", ConditionNode::name().c_str());
+        status = sendTickToSkill();
+        if (m_isCached)
+        {
+            // a fresh value from the skill restarts the staleness bound
+            std::lock_guard<std::mutex> lock(m_cacheMutex);
+            m_cachedStatus = status;
+            m_cachedStamp = std::chrono::steady_clock::now();
+        }
+    }
+    if (m_traceRecorder)
+    {
+        m_traceRecorder->recordTick(ConditionNode::name(), status);
+    }
     switch (status) {
         case message.SKILL_SUCCESS:
             return BT::NodeStatus::SUCCESS;
@@ -0,0 +1,156 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file ROS2SharedNode.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <ROS2SharedNode.h>
+
+ROS2SharedNode::ROS2SharedNode(const std::string& name, size_t numberOfThreads)
+{
+    if(!rclcpp::ok())
+    {
+        rclcpp::init(/*argc*/ 0, /*argv*/ nullptr);
+    }
+
+    m_node = rclcpp::Node::make_shared(name);
+    // the leaves block the ticking thread on their futures, the responses are
+    // dispatched here so they must not be serialized behind other callbacks
+    m_clientCallbackGroup = m_node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+    m_executor = std::make_shared<rclcpp::executors::MultiThreadedExecutor>(rclcpp::ExecutorOptions(), numberOfThreads);
+    m_executor->add_node(m_node);
+    m_haltCoordinator = std::make_shared<HaltCoordinator>();
+}
+
+
+ROS2SharedNode::~ROS2SharedNode()
+{
+    stop();
+}
+
+
+bool ROS2SharedNode::start()
+{
+    if(m_threadSpin)
+    {
+        return false;
+    }
+    m_threadSpin = std::make_shared<std::thread>([this]() { m_executor->spin(); });
+    RCLCPP_INFO(m_node->get_logger(), "ROS2SharedNode::start %s", m_node->get_name());
+    return true;
+}
+
+
+bool ROS2SharedNode::stop()
+{
+    if(!m_threadSpin)
+    {
+        return false;
+    }
+    m_executor->cancel();
+    if(m_threadSpin->joinable())
+    {
+        m_threadSpin->join();
+    }
+    m_threadSpin.reset();
+    return true;
+}
+
+
+std::shared_ptr<rclcpp::Node> ROS2SharedNode::node() const
+{
+    return m_node;
+}
+
+
+rclcpp::CallbackGroup::SharedPtr ROS2SharedNode::clientCallbackGroup() const
+{
+    return m_clientCallbackGroup;
+}
+
+
+void ROS2SharedNode::setTickScheduler(std::shared_ptr<TickScheduler> scheduler)
+{
+    m_tickScheduler = std::move(scheduler);
+}
+
+
+void ROS2SharedNode::requestTick()
+{
+    if(m_tickScheduler)
+    {
+        m_tickScheduler->requestTick();
+    }
+}
+
+
+void ROS2SharedNode::setLatencyMonitor(std::shared_ptr<LatencyMonitor> monitor)
+{
+    m_latencyMonitor = std::move(monitor);
+}
+
+
+std::shared_ptr<LatencyHistogram> ROS2SharedNode::latencyHistogram(const std::string& leaf, const std::string& request) const
+{
+    // no monitor, no measurement: the leaves skip recording on a null histogram
+    if(!m_latencyMonitor)
+    {
+        return nullptr;
+    }
+    return m_latencyMonitor->histogram(leaf, request);
+}
+
+
+void ROS2SharedNode::setTraceRecorder(std::shared_ptr<TraceRecorder> recorder)
+{
+    m_traceRecorder = std::move(recorder);
+}
+
+
+std::shared_ptr<TraceRecorder> ROS2SharedNode::traceRecorder() const
+{
+    return m_traceRecorder;
+}
+
+
+std::shared_ptr<HaltCoordinator> ROS2SharedNode::haltCoordinator() const
+{
+    return m_haltCoordinator;
+}
+
+
+bool ROS2SharedNode::watchTopic(const std::string& topic, const std::string& type)
+{
+    // the content is compared in its serialized form, so any message type can
+    // be watched and repeated identical messages do not trigger a tick
+    auto lastMessage = std::make_shared<std::vector<uint8_t>>();
+    try
+    {
+        auto subscription = m_node->create_generic_subscription(topic, type, rclcpp::QoS(10),
+            [this, topic, lastMessage](std::shared_ptr<const rclcpp::SerializedMessage> msg)
+            {
+                const auto& buffer = msg->get_rcl_serialized_message();
+                std::vector<uint8_t> current(buffer.buffer, buffer.buffer + buffer.buffer_length);
+                if(current == *lastMessage)
+                {
+                    return;
+                }
+                *lastMessage = std::move(current);
+                RCLCPP_DEBUG(m_node->get_logger(), "watched topic %s changed, requesting a tick", topic.c_str());
+                requestTick();
+            });
+        std::lock_guard<std::mutex> lock(m_watchedMutex);
+        m_watchedSubscriptions.push_back(subscription);
+    }
+    catch(const std::exception& e)
+    {
+        RCLCPP_ERROR(m_node->get_logger(), "Cannot watch topic %s of type %s: %s", topic.c_str(), type.c_str(), e.what());
+        return false;
+    }
+    return true;
+}
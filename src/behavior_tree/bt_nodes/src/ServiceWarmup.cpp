@@ -0,0 +1,99 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file ServiceWarmup.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <thread>
+#include <rclcpp/rclcpp.hpp>
+#include <ROS2Action.h>
+#include <ROS2Condition.h>
+
+#include <ServiceWarmup.h>
+
+ServiceWarmup::ServiceWarmup(const BT::Tree& tree)
+{
+    for (const BT::TreeNode::Ptr& node : tree.nodes)
+    {
+        if (auto action = dynamic_cast<ROS2Action*>(node.get()))
+        {
+            m_isConnected.emplace(action->name(), [action]() { return action->isConnected(); });
+        }
+        else if (auto condition = dynamic_cast<ROS2Condition*>(node.get()))
+        {
+            m_isConnected.emplace(condition->name(), [condition]() { return condition->isConnected(); });
+        }
+    }
+}
+
+
+std::vector<std::string> ServiceWarmup::skills() const
+{
+    std::vector<std::string> names;
+    for (const auto& entry : m_isConnected)
+    {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+
+std::vector<std::string> ServiceWarmup::waitFor(std::chrono::milliseconds timeout, const std::set<std::string>& skills)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::vector<std::string> missing;
+    while (true)
+    {
+        missing.clear();
+        for (const auto& [name, isConnected] : m_isConnected)
+        {
+            if ((skills.empty() || skills.count(name) > 0) && !isConnected())
+            {
+                missing.push_back(name);
+            }
+        }
+        if (missing.empty() || !rclcpp::ok() || std::chrono::steady_clock::now() >= deadline)
+        {
+            return missing;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+
+bool ServiceWarmup::waitUntilReady(std::chrono::milliseconds timeout, const std::set<std::string>& required)
+{
+    auto started = std::chrono::steady_clock::now();
+    RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Waiting for the services of %zu skills", m_isConnected.size());
+    std::vector<std::string> missing;
+    for (const auto& name : waitFor(timeout))
+    {
+        bool isRequired = required.count(name) > 0;
+        RCLCPP_WARN(rclcpp::get_logger("rclcpp"), "Skill %s not available after %ld ms%s", name.c_str(), static_cast<long>(timeout.count()),
+                    isRequired ? "" : ", not required");
+        if (isRequired)
+        {
+            missing.push_back(name);
+        }
+    }
+    while (!missing.empty())
+    {
+        missing = waitFor(std::chrono::seconds(5), required);
+        if (!rclcpp::ok())
+        {
+            return false;
+        }
+        for (const auto& name : missing)
+        {
+            RCLCPP_WARN(rclcpp::get_logger("rclcpp"), "Still waiting for the required skill %s", name.c_str());
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+    RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Required skills ready after %ld ms", static_cast<long>(elapsed.count()));
+    return true;
+}
@@ -0,0 +1,66 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TickScheduler.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <algorithm>
+
+#include <TickScheduler.h>
+
+TickScheduler::TickScheduler(std::chrono::milliseconds period, std::chrono::milliseconds minInterval) :
+        m_period(period),
+        m_minInterval(std::min(minInterval, period)),
+        m_lastTick(std::chrono::steady_clock::now())
+{
+}
+
+
+void TickScheduler::requestTick()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tickRequested = true;
+    }
+    m_condition.notify_one();
+}
+
+
+bool TickScheduler::waitForNextTick()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait_until(lock, m_lastTick + m_period, [this]() { return m_tickRequested || m_stopped; });
+    if (m_stopped)
+    {
+        return false;
+    }
+    // rate limit: an early request still waits for the minimum interval,
+    // requests arriving meanwhile are merged in the same tick
+    auto earliest = m_lastTick + m_minInterval;
+    if (std::chrono::steady_clock::now() < earliest)
+    {
+        m_condition.wait_until(lock, earliest, [this]() { return m_stopped; });
+        if (m_stopped)
+        {
+            return false;
+        }
+    }
+    m_tickRequested = false;
+    m_lastTick = std::chrono::steady_clock::now();
+    return true;
+}
+
+
+void TickScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+    }
+    m_condition.notify_all();
+}
@@ -0,0 +1,91 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TraceRecorder.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <TraceRecorder.h>
+
+TraceRecorder::TraceRecorder(const std::string& path) :
+        m_file(path, std::ios::binary | std::ios::trunc),
+        m_start(std::chrono::steady_clock::now())
+{
+    if (m_file)
+    {
+        m_file.write(trace::MAGIC, sizeof(trace::MAGIC));
+        write(trace::VERSION);
+    }
+}
+
+
+TraceRecorder::~TraceRecorder()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_file.flush();
+}
+
+
+bool TraceRecorder::isOpen() const
+{
+    return m_file.is_open();
+}
+
+
+uint64_t TraceRecorder::timestamp() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+
+uint16_t TraceRecorder::leafId(const std::string& leaf)
+{
+    auto it = m_leafIds.find(leaf);
+    if (it != m_leafIds.end())
+    {
+        return it->second;
+    }
+    auto id = static_cast<uint16_t>(m_leafIds.size());
+    m_leafIds.emplace(leaf, id);
+    write(trace::TraceRecord::LEAF_NAME);
+    write(id);
+    write(static_cast<uint16_t>(leaf.size()));
+    m_file.write(leaf.data(), leaf.size());
+    return id;
+}
+
+
+void TraceRecorder::beginTick()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // the records of the previous tick reach the file before a new one starts,
+    // a run killed mid-tick loses at most that tick
+    m_file.flush();
+    write(trace::TraceRecord::TICK_START);
+    write(timestamp());
+}
+
+
+void TraceRecorder::recordTick(const std::string& leaf, int8_t status)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint16_t id = leafId(leaf);
+    write(trace::TraceRecord::TICK_RESPONSE);
+    write(timestamp());
+    write(id);
+    write(status);
+}
+
+
+void TraceRecorder::recordHalt(const std::string& leaf)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint16_t id = leafId(leaf);
+    write(trace::TraceRecord::HALT);
+    write(timestamp());
+    write(id);
+}
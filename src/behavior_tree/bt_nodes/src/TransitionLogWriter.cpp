@@ -0,0 +1,167 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TransitionLogWriter.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <TransitionLogWriter.h>
+
+namespace
+{
+    size_t roundToPowerOfTwo(size_t value)
+    {
+        size_t power = 1;
+        while (power < value)
+        {
+            power <<= 1;
+        }
+        return power;
+    }
+}
+
+
+TransitionLogWriter::TransitionLogWriter(const std::string& basePath, size_t fileSize, size_t maxFiles, size_t ringCapacity) :
+        m_basePath(basePath),
+        m_fileSize(std::max(fileSize, sizeof(transition_log::FileHeader) + sizeof(transition_log::Record))),
+        m_maxFiles(std::max<size_t>(maxFiles, 1)),
+        m_ring(roundToPowerOfTwo(ringCapacity)),
+        m_mask(m_ring.size() - 1)
+{
+    m_fileCapacity = (m_fileSize - sizeof(transition_log::FileHeader)) / sizeof(transition_log::Record);
+    m_threadWrite = std::make_shared<std::thread>([this]() { run(); });
+}
+
+
+TransitionLogWriter::~TransitionLogWriter()
+{
+    stop();
+}
+
+
+bool TransitionLogWriter::push(const transition_log::Record& record)
+{
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) >= m_ring.size())
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_ring[head & m_mask] = record;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+
+void TransitionLogWriter::stop()
+{
+    if (!m_threadWrite)
+    {
+        return;
+    }
+    m_running.store(false);
+    if (m_threadWrite->joinable())
+    {
+        m_threadWrite->join();
+    }
+    m_threadWrite.reset();
+}
+
+
+void TransitionLogWriter::run()
+{
+    while (m_running.load())
+    {
+        drain();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    // the records pushed before stop() are still written
+    drain();
+    closeFile();
+}
+
+
+bool TransitionLogWriter::openNextFile()
+{
+    closeFile();
+    std::string path = m_basePath + "." + std::to_string(m_sequence % m_maxFiles) + ".bttl";
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_fd < 0 || ::ftruncate(m_fd, static_cast<off_t>(m_fileSize)) != 0)
+    {
+        std::cerr << "TransitionLogWriter: cannot create " << path << ": " << std::strerror(errno) << std::endl;
+        closeFile();
+        return false;
+    }
+    void* map = ::mmap(nullptr, m_fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED)
+    {
+        std::cerr << "TransitionLogWriter: cannot map " << path << ": " << std::strerror(errno) << std::endl;
+        closeFile();
+        return false;
+    }
+    m_map = static_cast<uint8_t*>(map);
+    auto header = reinterpret_cast<transition_log::FileHeader*>(m_map);
+    std::memcpy(header->magic, transition_log::MAGIC, sizeof(header->magic));
+    header->version = transition_log::VERSION;
+    header->sequence = m_sequence++;
+    header->recordCount = 0;
+    header->dropped = 0;
+    return true;
+}
+
+
+void TransitionLogWriter::closeFile()
+{
+    if (m_map != nullptr)
+    {
+        ::msync(m_map, m_fileSize, MS_ASYNC);
+        ::munmap(m_map, m_fileSize);
+        m_map = nullptr;
+    }
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+
+void TransitionLogWriter::drain()
+{
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    size_t head = m_head.load(std::memory_order_acquire);
+    while (tail != head)
+    {
+        auto header = reinterpret_cast<transition_log::FileHeader*>(m_map);
+        if (m_map == nullptr || header->recordCount >= m_fileCapacity)
+        {
+            if (!openNextFile())
+            {
+                // nothing can be written, the records are lost
+                m_dropped.fetch_add(head - tail, std::memory_order_relaxed);
+                m_tail.store(head, std::memory_order_release);
+                return;
+            }
+            header = reinterpret_cast<transition_log::FileHeader*>(m_map);
+        }
+        auto records = reinterpret_cast<transition_log::Record*>(m_map + sizeof(transition_log::FileHeader));
+        records[header->recordCount] = m_ring[tail & m_mask];
+        // the count is updated after the record, a reader never sees a partial one
+        header->recordCount++;
+        header->dropped = m_dropped.load(std::memory_order_relaxed);
+        ++tail;
+        m_tail.store(tail, std::memory_order_release);
+    }
+}
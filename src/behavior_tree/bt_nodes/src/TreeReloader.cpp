@@ -0,0 +1,88 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TreeReloader.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <rclcpp/rclcpp.hpp>
+#include <ServiceWarmup.h>
+
+#include <TreeReloader.h>
+
+TreeReloader::TreeReloader(BT::BehaviorTreeFactory& factory, std::chrono::milliseconds discoveryTimeout) :
+        m_factory(factory),
+        m_discoveryTimeout(discoveryTimeout)
+{
+}
+
+
+TreeReloader::~TreeReloader()
+{
+    if (m_threadBuild && m_threadBuild->joinable())
+    {
+        m_threadBuild->join();
+    }
+}
+
+
+bool TreeReloader::requestReload(const std::string& filePath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_building)
+    {
+        RCLCPP_WARN(rclcpp::get_logger("rclcpp"), "A tree is already being reloaded, request ignored");
+        return false;
+    }
+    if (m_threadBuild && m_threadBuild->joinable())
+    {
+        m_threadBuild->join();
+    }
+    m_building = true;
+    m_threadBuild = std::make_shared<std::thread>([this, filePath]() { build(filePath); });
+    return true;
+}
+
+
+std::unique_ptr<BT::Tree> TreeReloader::takeReadyTree()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::move(m_readyTree);
+}
+
+
+void TreeReloader::build(const std::string& filePath)
+{
+    RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Reloading the behavior tree...");
+    std::unique_ptr<BT::Tree> tree;
+    try
+    {
+        tree = std::make_unique<BT::Tree>(m_factory.createTreeFromFile(filePath));
+    }
+    catch (const std::exception& e)
+    {
+        RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Cannot load the behavior tree %s: %s", filePath.c_str(), e.what());
+    }
+    if (tree && !waitForServices(*tree))
+    {
+        RCLCPP_WARN(rclcpp::get_logger("rclcpp"), "Some skills are not available yet, the tree is used anyway");
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (tree)
+    {
+        // a tree built before and never taken is simply replaced
+        m_readyTree = std::move(tree);
+        RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Done reloading the behavior tree...");
+    }
+    m_building = false;
+}
+
+
+bool TreeReloader::waitForServices(const BT::Tree& tree)
+{
+    return ServiceWarmup(tree).waitFor(m_discoveryTimeout).empty();
+}
@@ -0,0 +1,78 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file MockSkills.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <behaviortree_cpp_v3/action_node.h>
+#include <behaviortree_cpp_v3/condition_node.h>
+#include <TraceReader.h>
+
+/**
+ * Serves the recorded replies to the mock leaves, tick by tick. A leaf gets
+ * the next reply recorded for its name in the current tick; when the tree
+ * asks for a reply that was not recorded, or does not ask for one that was,
+ * the replay has diverged from the recording (the tree XML changed).
+ */
+class ReplayState
+{
+public:
+    explicit ReplayState(const TraceReader& trace);
+    size_t tickCount() const;
+    uint64_t tickTimestamp(size_t tick) const;
+    void beginTick(size_t tick);
+    void endTick();
+    void setReplaying(bool replaying);
+    int8_t nextTick(const std::string& leaf);
+    void nextHalt(const std::string& leaf);
+    size_t divergences() const;
+    size_t firstDivergentTick() const;
+
+private:
+    void diverged(const std::string& what);
+
+    const TraceReader& m_trace;
+    std::map<std::string, uint16_t> m_leafIds;
+    std::map<uint16_t, int8_t> m_lastStatus;
+    std::vector<bool> m_consumed;
+    size_t m_tick{0};
+    bool m_replaying{false};
+    size_t m_divergences{0};
+    size_t m_firstDivergentTick{0};
+};
+
+
+class MockAction : public BT::ActionNodeBase
+{
+public:
+    MockAction(const std::string& name, const BT::NodeConfiguration& config, std::shared_ptr<ReplayState> state);
+    BT::NodeStatus tick() override;
+    void halt() override;
+    static BT::PortsList providedPorts();
+
+private:
+    std::shared_ptr<ReplayState> m_state;
+};
+
+
+class MockCondition : public BT::ConditionNode
+{
+public:
+    MockCondition(const std::string& name, const BT::NodeConfiguration& config, std::shared_ptr<ReplayState> state);
+    BT::NodeStatus tick() override;
+    static BT::PortsList providedPorts();
+
+private:
+    std::shared_ptr<ReplayState> m_state;
+};
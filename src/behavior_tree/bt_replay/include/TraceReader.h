@@ -0,0 +1,44 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TraceReader.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct TraceEvent
+{
+    uint16_t leaf;
+    bool isHalt;
+    int8_t status;
+};
+
+struct TraceTick
+{
+    uint64_t timestamp;
+    std::vector<TraceEvent> events;
+};
+
+/**
+ * Loads a trace written by TraceRecorder, split in the ticks of the root.
+ */
+class TraceReader
+{
+public:
+    bool read(const std::string& path);
+    const std::vector<std::string>& leafNames() const;
+    const std::vector<TraceTick>& ticks() const;
+
+private:
+    std::vector<std::string> m_leafNames;
+    std::vector<TraceTick> m_ticks;
+};
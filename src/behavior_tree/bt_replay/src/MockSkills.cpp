@@ -0,0 +1,202 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file MockSkills.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <iostream>
+#include <ROS2Action.h>
+#include <ROS2Condition.h>
+
+#include <MockSkills.h>
+
+namespace
+{
+    BT::NodeStatus toNodeStatus(int8_t status)
+    {
+        switch (status)
+        {
+            case bt_interfaces_dummy::msg::ActionResponse::SKILL_SUCCESS:
+                return BT::NodeStatus::SUCCESS;
+            case bt_interfaces_dummy::msg::ActionResponse::SKILL_RUNNING:
+                return BT::NodeStatus::RUNNING;
+            default:
+                return BT::NodeStatus::FAILURE;
+        }
+    }
+}
+
+
+ReplayState::ReplayState(const TraceReader& trace) :
+        m_trace(trace)
+{
+    for (size_t i = 0; i < trace.leafNames().size(); ++i)
+    {
+        m_leafIds[trace.leafNames()[i]] = static_cast<uint16_t>(i);
+    }
+}
+
+
+size_t ReplayState::tickCount() const
+{
+    return m_trace.ticks().size();
+}
+
+
+uint64_t ReplayState::tickTimestamp(size_t tick) const
+{
+    return m_trace.ticks()[tick].timestamp;
+}
+
+
+void ReplayState::beginTick(size_t tick)
+{
+    m_tick = tick;
+    m_consumed.assign(m_trace.ticks()[tick].events.size(), false);
+}
+
+
+void ReplayState::endTick()
+{
+    const auto& events = m_trace.ticks()[m_tick].events;
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        if (!m_consumed[i])
+        {
+            diverged(m_trace.leafNames()[events[i].leaf] + (events[i].isHalt ? " was halted" : " was ticked") + " in the recording only");
+        }
+    }
+}
+
+
+void ReplayState::setReplaying(bool replaying)
+{
+    m_replaying = replaying;
+}
+
+
+int8_t ReplayState::nextTick(const std::string& leaf)
+{
+    auto id = m_leafIds.find(leaf);
+    if (id != m_leafIds.end())
+    {
+        const auto& events = m_trace.ticks()[m_tick].events;
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            if (!m_consumed[i] && !events[i].isHalt && events[i].leaf == id->second)
+            {
+                m_consumed[i] = true;
+                m_lastStatus[id->second] = events[i].status;
+                return events[i].status;
+            }
+        }
+        diverged(leaf + " ticked but not in the recording");
+        auto last = m_lastStatus.find(id->second);
+        if (last != m_lastStatus.end())
+        {
+            return last->second;
+        }
+    }
+    else
+    {
+        diverged(leaf + " is not in the recording");
+    }
+    return bt_interfaces_dummy::msg::ActionResponse::SKILL_FAILURE;
+}
+
+
+void ReplayState::nextHalt(const std::string& leaf)
+{
+    // the halts sent when the tree is reset between two loops are not part of the replay
+    if (!m_replaying)
+    {
+        return;
+    }
+    auto id = m_leafIds.find(leaf);
+    if (id != m_leafIds.end())
+    {
+        const auto& events = m_trace.ticks()[m_tick].events;
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            if (!m_consumed[i] && events[i].isHalt && events[i].leaf == id->second)
+            {
+                m_consumed[i] = true;
+                return;
+            }
+        }
+    }
+    diverged(leaf + " halted but not in the recording");
+}
+
+
+void ReplayState::diverged(const std::string& what)
+{
+    if (m_divergences == 0)
+    {
+        m_firstDivergentTick = m_tick;
+        std::cerr << "tick " << m_tick << ": " << what << std::endl;
+    }
+    m_divergences++;
+}
+
+
+size_t ReplayState::divergences() const
+{
+    return m_divergences;
+}
+
+
+size_t ReplayState::firstDivergentTick() const
+{
+    return m_firstDivergentTick;
+}
+
+
+MockAction::MockAction(const std::string& name, const BT::NodeConfiguration& config, std::shared_ptr<ReplayState> state) :
+        ActionNodeBase(name, config),
+        m_state(std::move(state))
+{
+}
+
+
+BT::NodeStatus MockAction::tick()
+{
+    return toNodeStatus(m_state->nextTick(ActionNodeBase::name()));
+}
+
+
+void MockAction::halt()
+{
+    m_state->nextHalt(ActionNodeBase::name());
+}
+
+
+BT::PortsList MockAction::providedPorts()
+{
+    // same ports as the real leaf, so the unchanged tree XML can be loaded
+    return ROS2Action::providedPorts();
+}
+
+
+MockCondition::MockCondition(const std::string& name, const BT::NodeConfiguration& config, std::shared_ptr<ReplayState> state) :
+        ConditionNode(name, config),
+        m_state(std::move(state))
+{
+}
+
+
+BT::NodeStatus MockCondition::tick()
+{
+    return toNodeStatus(m_state->nextTick(ConditionNode::name()));
+}
+
+
+BT::PortsList MockCondition::providedPorts()
+{
+    return ROS2Condition::providedPorts();
+}
@@ -0,0 +1,124 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TraceReader.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <TraceFormat.h>
+
+#include <TraceReader.h>
+
+namespace
+{
+    template <typename T>
+    bool readValue(std::ifstream& file, T& value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    bool truncated(const std::string& path, bool hasTicks)
+    {
+        // the recording was interrupted, the complete records are still usable
+        std::cerr << path << " is truncated, replaying the complete records only" << std::endl;
+        return hasTicks;
+    }
+}
+
+
+bool TraceReader::read(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(trace::MAGIC)];
+    uint32_t version = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, trace::MAGIC, sizeof(magic)) != 0 || !readValue(file, version))
+    {
+        std::cerr << path << " is not a behavior tree trace" << std::endl;
+        return false;
+    }
+    if (version != trace::VERSION)
+    {
+        std::cerr << path << " has trace version " << version << ", expected " << trace::VERSION << std::endl;
+        return false;
+    }
+
+    trace::TraceRecord type;
+    while (readValue(file, type))
+    {
+        uint64_t timestamp = 0;
+        uint16_t leaf = 0;
+        switch (type)
+        {
+            case trace::TraceRecord::LEAF_NAME:
+            {
+                uint16_t length = 0;
+                if (!readValue(file, leaf) || !readValue(file, length))
+                {
+                    return truncated(path, !m_ticks.empty());
+                }
+                std::string name(length, '\0');
+                file.read(name.data(), length);
+                if (m_leafNames.size() <= leaf)
+                {
+                    m_leafNames.resize(leaf + 1);
+                }
+                m_leafNames[leaf] = name;
+                break;
+            }
+            case trace::TraceRecord::TICK_START:
+                if (!readValue(file, timestamp))
+                {
+                    return truncated(path, !m_ticks.empty());
+                }
+                m_ticks.push_back({timestamp, {}});
+                break;
+            case trace::TraceRecord::TICK_RESPONSE:
+            {
+                int8_t status = 0;
+                if (!readValue(file, timestamp) || !readValue(file, leaf) || !readValue(file, status))
+                {
+                    return truncated(path, !m_ticks.empty());
+                }
+                // replies recorded before the first tick boundary cannot be replayed
+                if (!m_ticks.empty())
+                {
+                    m_ticks.back().events.push_back({leaf, false, status});
+                }
+                break;
+            }
+            case trace::TraceRecord::HALT:
+                if (!readValue(file, timestamp) || !readValue(file, leaf))
+                {
+                    return truncated(path, !m_ticks.empty());
+                }
+                if (!m_ticks.empty())
+                {
+                    m_ticks.back().events.push_back({leaf, true, 0});
+                }
+                break;
+            default:
+                std::cerr << path << ": unknown record type " << static_cast<int>(type) << std::endl;
+                return false;
+        }
+    }
+    return true;
+}
+
+
+const std::vector<std::string>& TraceReader::leafNames() const
+{
+    return m_leafNames;
+}
+
+
+const std::vector<TraceTick>& TraceReader::ticks() const
+{
+    return m_ticks;
+}
@@ -0,0 +1,202 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file bt_log_convert.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <behaviortree_cpp_v3/bt_factory.h>
+#include <behaviortree_cpp_v3/flatbuffers/bt_flatbuffer_helper.h>
+#include <ROS2Action.h>
+#include <ROS2Condition.h>
+#include <TransitionLogFormat.h>
+
+using namespace std;
+using namespace BT;
+
+
+// the tree is only rebuilt to get the UIDs, names and types of its nodes
+class PlaceholderAction : public ActionNodeBase
+{
+public:
+    PlaceholderAction(const string& name, const NodeConfiguration& config) : ActionNodeBase(name, config) {}
+    NodeStatus tick() override { return NodeStatus::FAILURE; }
+    void halt() override {}
+    static PortsList providedPorts() { return ROS2Action::providedPorts(); }
+};
+
+
+class PlaceholderCondition : public ConditionNode
+{
+public:
+    PlaceholderCondition(const string& name, const NodeConfiguration& config) : ConditionNode(name, config) {}
+    NodeStatus tick() override { return NodeStatus::FAILURE; }
+    static PortsList providedPorts() { return ROS2Condition::providedPorts(); }
+};
+
+
+struct LogFile
+{
+    transition_log::FileHeader header;
+    vector<transition_log::Record> records;
+};
+
+
+bool readLogFile(const string& path, LogFile& log)
+{
+    ifstream file(path, ios::binary);
+    if (!file.read(reinterpret_cast<char*>(&log.header), sizeof(log.header)) ||
+        memcmp(log.header.magic, transition_log::MAGIC, sizeof(log.header.magic)) != 0 ||
+        log.header.version != transition_log::VERSION)
+    {
+        cerr << path << " is not a transition log" << endl;
+        return false;
+    }
+    log.records.resize(log.header.recordCount);
+    file.read(reinterpret_cast<char*>(log.records.data()), log.records.size() * sizeof(transition_log::Record));
+    log.records.resize(file.gcount() / sizeof(transition_log::Record));
+    if (log.header.dropped > 0)
+    {
+        cerr << path << ": " << log.header.dropped << " transitions were dropped while recording" << endl;
+    }
+    return true;
+}
+
+
+void writeFbl(const string& path, const Tree& tree, const vector<transition_log::Record>& records)
+{
+    ofstream file(path, ios::binary);
+    flatbuffers::FlatBufferBuilder builder(1024);
+    CreateFlatbuffersBehaviorTree(builder, tree);
+    const uint32_t payload_size = builder.GetSize();
+    file.write(reinterpret_cast<const char*>(&payload_size), sizeof(payload_size));
+    file.write(reinterpret_cast<const char*>(builder.GetBufferPointer()), payload_size);
+    for (const auto& record : records)
+    {
+        auto transition = SerializeTransition(record.uid, Duration(chrono::nanoseconds(record.timestamp)),
+                                              static_cast<NodeStatus>(record.previousStatus), static_cast<NodeStatus>(record.status));
+        file.write(reinterpret_cast<const char*>(transition.data()), transition.size());
+    }
+}
+
+
+void writeMinitrace(const string& path, const map<uint16_t, const TreeNode*>& nodes, const vector<transition_log::Record>& records)
+{
+    // same events the MinitraceLogger emits: instant for a node completing in
+    // one tick, begin/end around a RUNNING one
+    ofstream file(path);
+    file << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& record : records)
+    {
+        auto node = nodes.at(record.uid);
+        auto prev = static_cast<NodeStatus>(record.previousStatus);
+        auto status = static_cast<NodeStatus>(record.status);
+        bool completed = status == NodeStatus::SUCCESS || status == NodeStatus::FAILURE;
+        const char* phase = nullptr;
+        if (prev == NodeStatus::IDLE && completed)
+        {
+            phase = "I";
+        }
+        else if (status == NodeStatus::RUNNING)
+        {
+            phase = "B";
+        }
+        else if (prev == NodeStatus::RUNNING && completed)
+        {
+            phase = "E";
+        }
+        if (phase == nullptr)
+        {
+            continue;
+        }
+        file << (first ? "\n" : ",\n")
+             << "{\"cat\":\"" << toStr(node->type()) << "\",\"pid\":0,\"tid\":0,\"ts\":" << record.timestamp / 1000
+             << ",\"ph\":\"" << phase << "\",\"name\":\"" << node->name() << "\",\"args\":{}}";
+        first = false;
+    }
+    file << "\n],\n\"displayTimeUnit\":\"ns\"}\n";
+}
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4)
+    {
+        cerr << "usage: bt_log_convert <tree.xml> <output.fbl|output.json> <log.bttl>..." << endl;
+        return 2;
+    }
+    BehaviorTreeFactory bt_factory;
+    bt_factory.registerNodeType<PlaceholderAction>("ROS2Action");
+    bt_factory.registerNodeType<PlaceholderCondition>("ROS2Condition");
+    Tree tree = bt_factory.createTreeFromFile(argv[1]);
+    map<uint16_t, const TreeNode*> nodes;
+    for (const auto& node : tree.nodes)
+    {
+        nodes[node->UID()] = node.get();
+    }
+
+    vector<LogFile> logs;
+    for (int i = 3; i < argc; ++i)
+    {
+        LogFile log;
+        if (readLogFile(argv[i], log))
+        {
+            logs.push_back(move(log));
+        }
+    }
+    // the files rotate, their sequence number gives the order
+    sort(logs.begin(), logs.end(), [](const LogFile& a, const LogFile& b) { return a.header.sequence < b.header.sequence; });
+
+    vector<transition_log::Record> records;
+    size_t trees = 0;
+    for (const auto& log : logs)
+    {
+        for (const auto& record : log.records)
+        {
+            if (record.uid == transition_log::TREE_CHANGED_UID)
+            {
+                trees++;
+                continue;
+            }
+            // only the first tree can be matched against the XML
+            if (trees > 1)
+            {
+                break;
+            }
+            if (nodes.count(record.uid) == 0)
+            {
+                cerr << "UID " << record.uid << " is not in " << argv[1] << ", is it the tree of this log?" << endl;
+                return 1;
+            }
+            records.push_back(record);
+        }
+    }
+    if (trees > 1)
+    {
+        cerr << "the tree was reloaded during the recording, only the transitions of the first one are converted" << endl;
+    }
+
+    const string output = argv[2];
+    if (output.size() > 4 && output.compare(output.size() - 4, 4, ".fbl") == 0)
+    {
+        writeFbl(output, tree, records);
+    }
+    else
+    {
+        writeMinitrace(output, nodes, records);
+    }
+    cout << "converted " << records.size() << " transitions into " << output << endl;
+    return 0;
+}
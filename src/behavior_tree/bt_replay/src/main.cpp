@@ -0,0 +1,111 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file main.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <behaviortree_cpp_v3/bt_factory.h>
+#include <LatencyHistogram.h>
+#include <MockSkills.h>
+#include <TraceReader.h>
+
+using namespace std;
+using namespace BT;
+
+/**
+ * Replays a trace recorded by bt_executable (trace_path parameter) against a
+ * tree XML, with mock skills answering what the real ones answered. Without
+ * --realtime the ticks run back to back, which measures the traversal cost
+ * of the engine alone. The exit code is 1 when the tree did not ask for the
+ * recorded replies, e.g. because the XML changed since the recording.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        cerr << "usage: bt_replay <tree.xml> <trace.bttr> [loops] [--realtime]" << endl;
+        return 2;
+    }
+    const string tree_path = argv[1];
+    const string trace_path = argv[2];
+    size_t loops = 1;
+    bool realtime = false;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--realtime") == 0)
+        {
+            realtime = true;
+        }
+        else
+        {
+            loops = stoul(argv[i]);
+        }
+    }
+
+    TraceReader trace;
+    if (!trace.read(trace_path) || trace.ticks().empty())
+    {
+        cerr << "nothing to replay in " << trace_path << endl;
+        return 2;
+    }
+
+    auto state = make_shared<ReplayState>(trace);
+    BehaviorTreeFactory bt_factory;
+    bt_factory.registerBuilder<MockAction>("ROS2Action",
+        [state](const string& name, const NodeConfiguration& config)
+        {
+            return make_unique<MockAction>(name, config, state);
+        });
+    bt_factory.registerBuilder<MockCondition>("ROS2Condition",
+        [state](const string& name, const NodeConfiguration& config)
+        {
+            return make_unique<MockCondition>(name, config, state);
+        });
+    Tree tree = bt_factory.createTreeFromFile(tree_path);
+
+    // traversal cost of one tick, in nanoseconds
+    LatencyHistogram tick_cost;
+    auto started = chrono::steady_clock::now();
+    for (size_t loop = 0; loop < loops; ++loop)
+    {
+        auto loop_started = chrono::steady_clock::now();
+        state->setReplaying(true);
+        for (size_t i = 0; i < state->tickCount(); ++i)
+        {
+            if (realtime)
+            {
+                this_thread::sleep_until(loop_started + chrono::microseconds(state->tickTimestamp(i) - state->tickTimestamp(0)));
+            }
+            state->beginTick(i);
+            auto tick_started = chrono::steady_clock::now();
+            tree.tickRoot();
+            tick_cost.record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - tick_started).count());
+            state->endTick();
+        }
+        // every loop is a new tour, starting from an idle tree
+        state->setReplaying(false);
+        tree.haltTree();
+    }
+    auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+    cout << "replayed " << loops << " x " << state->tickCount() << " ticks of " << trace_path
+         << " in " << elapsed << " s (" << (loops * 60.0 / elapsed) << " tours/min)" << endl;
+    cout << "tick cost ns: p50 " << tick_cost.percentile(50) << ", p95 " << tick_cost.percentile(95)
+         << ", p99 " << tick_cost.percentile(99) << ", max " << tick_cost.max() << endl;
+    if (state->divergences() > 0)
+    {
+        cout << state->divergences() << " divergences from the recording, the first at tick " << state->firstDivergentTick() << endl;
+        return 1;
+    }
+    return 0;
+}
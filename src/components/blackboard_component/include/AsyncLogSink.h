@@ -0,0 +1,53 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2020 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <rclcpp/rclcpp.hpp>
+
+/**
+ * Debug log of the service callbacks, written by a thread of its own so that
+ * a callback never waits for the console. The message is only built when
+ * the debug level is enabled for the logger (--ros-args --log-level
+ * <node>:=debug); when the writer falls behind by more than MAX_PENDING
+ * messages the new ones are dropped and counted.
+ */
+class AsyncLogSink
+{
+public:
+    static constexpr size_t MAX_PENDING = 10000;
+
+    explicit AsyncLogSink(rclcpp::Logger logger);
+    ~AsyncLogSink();
+
+    template <typename MessageT>
+    void debug(MessageT&& message)
+    {
+        if (!rcutils_logging_logger_is_enabled_for(m_logger.get_name(), RCUTILS_LOG_SEVERITY_DEBUG))
+        {
+            return;
+        }
+        push(message());
+    }
+
+private:
+    void push(std::string message);
+    void write();
+
+    rclcpp::Logger m_logger;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::string> m_pending;
+    size_t m_dropped{0};
+    bool m_stopping{false};
+    std::thread m_writer;
+};
@@ -6,7 +6,7 @@
  ******************************************************************************/
 
 
-#include <mutex>
+#include <memory>
 #include <rclcpp/rclcpp.hpp>
 #include <blackboard_interfaces/srv/get_double_blackboard.hpp>
 #include <blackboard_interfaces/srv/set_double_blackboard.hpp>
@@ -15,7 +15,11 @@
 #include <blackboard_interfaces/srv/set_string_blackboard.hpp>
 #include <blackboard_interfaces/srv/get_string_blackboard.hpp>
 #include <blackboard_interfaces/srv/set_all_ints_with_prefix_blackboard.hpp>
-#include <map>
+#include <blackboard_interfaces/srv/get_many_blackboard.hpp>
+#include <blackboard_interfaces/srv/set_many_blackboard.hpp>
+#include <blackboard_interfaces/srv/compare_and_set_blackboard.hpp>
+#include "AsyncLogSink.h"
+#include "BlackboardStore.h"
 
 class BlackboardComponent
 {
@@ -40,9 +44,18 @@ public:
                 std::shared_ptr<blackboard_interfaces::srv::SetStringBlackboard::Response>      response);
     void SetAllIntsWithPrefix( const std::shared_ptr<blackboard_interfaces::srv::SetAllIntsWithPrefixBlackboard::Request> request,
                 std::shared_ptr<blackboard_interfaces::srv::SetAllIntsWithPrefixBlackboard::Response>      response);
+    void GetMany( const std::shared_ptr<blackboard_interfaces::srv::GetManyBlackboard::Request> request,
+                std::shared_ptr<blackboard_interfaces::srv::GetManyBlackboard::Response>      response);
+    void SetMany( const std::shared_ptr<blackboard_interfaces::srv::SetManyBlackboard::Request> request,
+                std::shared_ptr<blackboard_interfaces::srv::SetManyBlackboard::Response>      response);
+    void CompareAndSet( const std::shared_ptr<blackboard_interfaces::srv::CompareAndSetBlackboard::Request> request,
+                std::shared_ptr<blackboard_interfaces::srv::CompareAndSetBlackboard::Response>      response);
 
 private:
     rclcpp::Node::SharedPtr m_node;
+    // the services run in parallel on the threads of spin(), BlackboardStore
+    // serializes only the requests on the same shard
+    rclcpp::CallbackGroup::SharedPtr m_callbackGroup;
     rclcpp::Service<blackboard_interfaces::srv::SetDoubleBlackboard>::SharedPtr m_setDoubleService;
     rclcpp::Service<blackboard_interfaces::srv::GetDoubleBlackboard>::SharedPtr m_getDoubleService;
     rclcpp::Service<blackboard_interfaces::srv::SetIntBlackboard>::SharedPtr m_setIntService;
@@ -50,11 +63,10 @@ private:
     rclcpp::Service<blackboard_interfaces::srv::SetStringBlackboard>::SharedPtr m_setStringService;
     rclcpp::Service<blackboard_interfaces::srv::GetStringBlackboard>::SharedPtr m_getStringService;
     rclcpp::Service<blackboard_interfaces::srv::SetAllIntsWithPrefixBlackboard>::SharedPtr m_setAllIntsWithPrefixService;
-    std::mutex m_mutexDouble;
-    std::mutex m_mutexInt;
-    std::mutex m_mutexString;
-    std::map<std::string, std::string> m_stringBlackboard;
-    std::map<std::string, double> m_doubleBlackboard;
-    std::map<std::string, int32_t> m_intBlackboard;
+    rclcpp::Service<blackboard_interfaces::srv::GetManyBlackboard>::SharedPtr m_getManyService;
+    rclcpp::Service<blackboard_interfaces::srv::SetManyBlackboard>::SharedPtr m_setManyService;
+    rclcpp::Service<blackboard_interfaces::srv::CompareAndSetBlackboard>::SharedPtr m_compareAndSetService;
+    BlackboardStore m_store;
+    std::unique_ptr<AsyncLogSink> m_log;
 
 };
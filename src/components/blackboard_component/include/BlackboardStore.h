@@ -0,0 +1,119 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2020 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// the alternatives are the types of the blackboard, each with its own fields:
+// an int and a string called "x" are two different entries
+using BlackboardValue = std::variant<int32_t, double, std::string>;
+// a field with the index of its type in BlackboardValue
+using BlackboardKey = std::pair<std::string_view, size_t>;
+using BlackboardField = std::pair<std::string_view, BlackboardValue>;
+
+/**
+ * Typed store of the blackboard. The fields are spread over SHARDS shards by
+ * the hash of their name, each behind a reader/writer lock: gets only take
+ * the shared lock of one shard and never wait for each other, a set locks
+ * the shard of its field only. Lookups take the name as a string_view, a
+ * get does not allocate.
+ */
+class BlackboardStore
+{
+public:
+    static constexpr size_t SHARDS = 16;
+
+    template <typename T>
+    std::optional<T> get(std::string_view name) const
+    {
+        const Shard& shard = m_shards[shardIndex(name)];
+        std::shared_lock lock(shard.mutex);
+        const auto& fields = shard.fields[typeIndex<T>()];
+        auto field = fields.find(name);
+        if (field == fields.end())
+        {
+            return std::nullopt;
+        }
+        return std::get<T>(field->second);
+    }
+
+    // true when the field already had a value of the same type
+    bool set(std::string_view name, BlackboardValue value);
+    // sets the fields of the type of value whose name starts with prefix, all
+    // at once with respect to the readers; returns how many were set
+    size_t setAllWithPrefix(std::string_view prefix, const BlackboardValue& value);
+
+    // batches: the shards of all the fields are locked, in index order, for
+    // the whole operation, so a batch is atomic with respect to the others
+    // and to the single gets and sets
+    std::vector<std::optional<BlackboardValue>> getMany(const std::vector<BlackboardKey>& keys) const;
+    void setMany(std::vector<BlackboardField> fields);
+    // writes fields only if every expected field holds its value; otherwise
+    // current gets the values of the expected fields (nullopt when missing)
+    bool compareAndSet(const std::vector<BlackboardField>& expected, std::vector<BlackboardField> fields,
+                       std::vector<std::optional<BlackboardValue>>& current);
+
+private:
+    struct NameHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+    };
+    using Fields = std::unordered_map<std::string, BlackboardValue, NameHash, std::equal_to<>>;
+
+    struct Shard
+    {
+        mutable std::shared_mutex mutex;
+        std::array<Fields, std::variant_size_v<BlackboardValue>> fields;
+    };
+
+    template <typename T, typename... Alternatives>
+    static constexpr size_t alternativeIndex(std::variant<Alternatives...>*)
+    {
+        return std::variant<std::type_identity<Alternatives>...>(std::type_identity<T>()).index();
+    }
+
+    template <typename T>
+    static constexpr size_t typeIndex()
+    {
+        return alternativeIndex<T>(static_cast<BlackboardValue*>(nullptr));
+    }
+
+    static size_t shardIndex(std::string_view name) { return NameHash()(name) % SHARDS; }
+
+    template <typename LockT>
+    std::vector<LockT> lockShards(const std::array<bool, SHARDS>& shards) const
+    {
+        std::vector<LockT> locks;
+        for (size_t i = 0; i < SHARDS; i++)
+        {
+            if (shards[i])
+            {
+                locks.emplace_back(m_shards[i].mutex);
+            }
+        }
+        return locks;
+    }
+
+    // with the lock of the shard of name held
+    const BlackboardValue* find(std::string_view name, size_t type) const;
+    bool assign(std::string_view name, BlackboardValue value);
+
+    std::array<Shard, SHARDS> m_shards;
+};
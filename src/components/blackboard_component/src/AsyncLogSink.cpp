@@ -0,0 +1,70 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2020 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+
+#include "AsyncLogSink.h"
+
+AsyncLogSink::AsyncLogSink(rclcpp::Logger logger) :
+        m_logger(std::move(logger)),
+        m_writer(&AsyncLogSink::write, this)
+{
+}
+
+
+AsyncLogSink::~AsyncLogSink()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_one();
+    m_writer.join();
+}
+
+
+void AsyncLogSink::push(std::string message)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pending.size() >= MAX_PENDING)
+        {
+            m_dropped++;
+            return;
+        }
+        m_pending.push_back(std::move(message));
+    }
+    m_condition.notify_one();
+}
+
+
+void AsyncLogSink::write()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_condition.wait(lock, [this]() { return m_stopping || !m_pending.empty(); });
+        // the pending messages are written after a stop request too
+        std::deque<std::string> messages;
+        messages.swap(m_pending);
+        size_t dropped = m_dropped;
+        m_dropped = 0;
+        bool stopping = m_stopping;
+        lock.unlock();
+        for (const auto& message : messages)
+        {
+            RCLCPP_DEBUG(m_logger, "%s", message.c_str());
+        }
+        if (dropped > 0)
+        {
+            RCLCPP_WARN(m_logger, "%zu log messages dropped", dropped);
+        }
+        lock.lock();
+        if (stopping && m_pending.empty())
+        {
+            return;
+        }
+    }
+}
@@ -8,6 +8,64 @@
 
 #include "BlackboardComponent.h"
 
+using blackboard_interfaces::msg::BlackboardEntry;
+
+namespace
+{
+// checks an entry of a batch request, error_msg says what is wrong with it
+bool checkEntry(const BlackboardEntry& entry, bool isWrite, std::string& error_msg)
+{
+    if (entry.field_name == "") {
+        error_msg = "missing required field name";
+    } else if (entry.type > BlackboardEntry::STRING) {
+        error_msg = "unknown type " + std::to_string(entry.type) + " for " + entry.field_name;
+    } else if (isWrite && entry.type == BlackboardEntry::STRING && entry.string_value == "") {
+        error_msg = "missing required value for " + entry.field_name;
+    } else {
+        return true;
+    }
+    return false;
+}
+
+// the alternatives of BlackboardValue are in the order of the type constants of BlackboardEntry
+static_assert(BlackboardValue(int32_t()).index() == BlackboardEntry::INT);
+static_assert(BlackboardValue(double()).index() == BlackboardEntry::DOUBLE);
+
+BlackboardValue entryValue(const BlackboardEntry& entry)
+{
+    switch (entry.type) {
+    case BlackboardEntry::INT:
+        return entry.int_value;
+    case BlackboardEntry::DOUBLE:
+        return entry.double_value;
+    default:
+        return entry.string_value;
+    }
+}
+
+void setEntryValue(BlackboardEntry& entry, const BlackboardValue& value)
+{
+    entry.type = static_cast<uint8_t>(value.index());
+    if (auto intValue = std::get_if<int32_t>(&value)) {
+        entry.int_value = *intValue;
+    } else if (auto doubleValue = std::get_if<double>(&value)) {
+        entry.double_value = *doubleValue;
+    } else {
+        entry.string_value = std::get<std::string>(value);
+    }
+}
+
+std::vector<BlackboardField> entryFields(const std::vector<BlackboardEntry>& entries)
+{
+    std::vector<BlackboardField> fields;
+    fields.reserve(entries.size());
+    for (const auto& entry : entries) {
+        fields.emplace_back(entry.field_name, entryValue(entry));
+    }
+    return fields;
+}
+}
+
 bool BlackboardComponent::start(int argc, char*argv[])
 {
 
@@ -16,41 +74,78 @@ bool BlackboardComponent::start(int argc, char*argv[])
         rclcpp::init(/*argc*/ argc, /*argv*/ argv);
     }
     m_node = rclcpp::Node::make_shared("BlackboardComponentNode");
+    m_callbackGroup = m_node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+    m_log = std::make_unique<AsyncLogSink>(m_node->get_logger());
     m_setDoubleService = m_node->create_service<blackboard_interfaces::srv::SetDoubleBlackboard>("/BlackboardComponent/SetDouble",  
                                                                                 std::bind(&BlackboardComponent::SetDouble,
                                                                                 this,
                                                                                 std::placeholders::_1,
-                                                                                std::placeholders::_2));
+                                                                                std::placeholders::_2),
+                                                                                rclcpp::ServicesQoS(),
+                                                                                m_callbackGroup);
     m_getDoubleService = m_node->create_service<blackboard_interfaces::srv::GetDoubleBlackboard>("/BlackboardComponent/GetDouble",  
                                                                                 std::bind(&BlackboardComponent::GetDouble,
                                                                                 this,
                                                                                 std::placeholders::_1,
-                                                                                std::placeholders::_2));
+                                                                                std::placeholders::_2),
+                                                                                rclcpp::ServicesQoS(),
+                                                                                m_callbackGroup);
     m_setIntService = m_node->create_service<blackboard_interfaces::srv::SetIntBlackboard>("/BlackboardComponent/SetInt",  
                                                                                 std::bind(&BlackboardComponent::SetInt,
                                                                                 this,
                                                                                 std::placeholders::_1,
-                                                                                std::placeholders::_2));
+                                                                                std::placeholders::_2),
+                                                                                rclcpp::ServicesQoS(),
+                                                                                m_callbackGroup);
     m_getIntService = m_node->create_service<blackboard_interfaces::srv::GetIntBlackboard>("/BlackboardComponent/GetInt",  
                                                                                 std::bind(&BlackboardComponent::GetInt,
                                                                                 this,
                                                                                 std::placeholders::_1,
-                                                                                std::placeholders::_2));
+                                                                                std::placeholders::_2),
+                                                                                rclcpp::ServicesQoS(),
+                                                                                m_callbackGroup);
     m_setStringService = m_node->create_service<blackboard_interfaces::srv::SetStringBlackboard>("/BlackboardComponent/SetString",  
                                                                                 std::bind(&BlackboardComponent::SetString,
                                                                                 this,
                                                                                 std::placeholders::_1,
-                                                                                std::placeholders::_2));
+                                                                                std::placeholders::_2),
+                                                                                rclcpp::ServicesQoS(),
+                                                                                m_callbackGroup);
     m_getStringService = m_node->create_service<blackboard_interfaces::srv::GetStringBlackboard>("/BlackboardComponent/GetString",  
                                                                                 std::bind(&BlackboardComponent::GetString,
                                                                                 this,
                                                                                 std::placeholders::_1,
-                                                                                std::placeholders::_2));
+                                                                                std::placeholders::_2),
+                                                                                rclcpp::ServicesQoS(),
+                                                                                m_callbackGroup);
     m_setAllIntsWithPrefixService = m_node->create_service<blackboard_interfaces::srv::SetAllIntsWithPrefixBlackboard>("/BlackboardComponent/SetAllIntsWithPrefix",  
                                                                                 std::bind(&BlackboardComponent::SetAllIntsWithPrefix,
                                                                                 this,
                                                                                 std::placeholders::_1,
-                                                                                std::placeholders::_2));
+                                                                                std::placeholders::_2),
+                                                                                rclcpp::ServicesQoS(),
+                                                                                m_callbackGroup);
+    m_getManyService = m_node->create_service<blackboard_interfaces::srv::GetManyBlackboard>("/BlackboardComponent/GetMany",  
+                                                                                std::bind(&BlackboardComponent::GetMany,
+                                                                                this,
+                                                                                std::placeholders::_1,
+                                                                                std::placeholders::_2),
+                                                                                rclcpp::ServicesQoS(),
+                                                                                m_callbackGroup);
+    m_setManyService = m_node->create_service<blackboard_interfaces::srv::SetManyBlackboard>("/BlackboardComponent/SetMany",  
+                                                                                std::bind(&BlackboardComponent::SetMany,
+                                                                                this,
+                                                                                std::placeholders::_1,
+                                                                                std::placeholders::_2),
+                                                                                rclcpp::ServicesQoS(),
+                                                                                m_callbackGroup);
+    m_compareAndSetService = m_node->create_service<blackboard_interfaces::srv::CompareAndSetBlackboard>("/BlackboardComponent/CompareAndSet",  
+                                                                                std::bind(&BlackboardComponent::CompareAndSet,
+                                                                                this,
+                                                                                std::placeholders::_1,
+                                                                                std::placeholders::_2),
+                                                                                rclcpp::ServicesQoS(),
+                                                                                m_callbackGroup);
     RCLCPP_DEBUG(m_node->get_logger(), "BlackboardComponent::start");
     std::cout << "BlackboardComponent::start" << std::endl;        
     return true;
@@ -65,23 +160,27 @@ bool BlackboardComponent::close()
 
 void BlackboardComponent::spin()
 {
-    rclcpp::spin(m_node);  
+    // 0 is one thread per core
+    auto threads = m_node->declare_parameter<int>("threads", 0);
+    rclcpp::executors::MultiThreadedExecutor executor(rclcpp::ExecutorOptions(), static_cast<size_t>(threads));
+    executor.add_node(m_node);
+    executor.spin();
 }
 
 void BlackboardComponent::GetDouble( const std::shared_ptr<blackboard_interfaces::srv::GetDoubleBlackboard::Request> request,
              std::shared_ptr<blackboard_interfaces::srv::GetDoubleBlackboard::Response>      response) 
 {
-    std::lock_guard<std::mutex> lock(m_mutexDouble);
     if (request->field_name == "") {
         response->is_ok = false;
         response->error_msg = "missing required field name";
     } else {
-        if (!m_doubleBlackboard.contains(request->field_name)) {
+        auto value = m_store.get<double>(request->field_name);
+        if (!value) {
             response->is_ok = false;
             response->error_msg = "field not found";
         } else {
-            response->value = m_doubleBlackboard.find(request->field_name)->second;  
-            std::cout << "GetDouble: " << request->field_name << " " << response->value << std::endl; 
+            response->value = *value;
+            m_log->debug([&]() { return "GetDouble: " + request->field_name + " " + std::to_string(response->value); });
             response->is_ok = true;
         }
     }
@@ -91,7 +190,6 @@ void BlackboardComponent::GetDouble( const std::shared_ptr<blackboard_interfaces
 void BlackboardComponent::SetDouble( const std::shared_ptr<blackboard_interfaces::srv::SetDoubleBlackboard::Request> request,
              std::shared_ptr<blackboard_interfaces::srv::SetDoubleBlackboard::Response>      response) 
 {
-    std::lock_guard<std::mutex> lock(m_mutexDouble);
     if (request->field_name == "") {
         response->is_ok = false;
         response->error_msg = "missing required field name";
@@ -99,11 +197,10 @@ void BlackboardComponent::SetDouble( const std::shared_ptr<blackboard_interfaces
         response->is_ok = false;
         response->error_msg = "missing required value";
     } else {
-        if (m_doubleBlackboard.contains(request->field_name)) {
+        if (m_store.set(request->field_name, request->value)) {
             response->error_msg = "field already present, overwriting";
-        } 
-        m_doubleBlackboard.insert_or_assign(request->field_name, request->value);  
-        std::cout << "SetDouble: " << request->field_name << " " << request->value << std::endl;
+        }
+        m_log->debug([&]() { return "SetDouble: " + request->field_name + " " + std::to_string(request->value); });
         response->is_ok = true;
     }
 }
@@ -112,25 +209,25 @@ void BlackboardComponent::SetDouble( const std::shared_ptr<blackboard_interfaces
 void BlackboardComponent::GetString( const std::shared_ptr<blackboard_interfaces::srv::GetStringBlackboard::Request> request,
              std::shared_ptr<blackboard_interfaces::srv::GetStringBlackboard::Response>      response) 
 {
-    std::lock_guard<std::mutex> lock(m_mutexString);
     if (request->field_name == "") {
         response->is_ok = false;
         response->error_msg = "missing required field name";
-    } else if (!m_stringBlackboard.contains(request->field_name)) {
+        return;
+    }
+    auto value = m_store.get<std::string>(request->field_name);
+    if (!value) {
         response->is_ok = false;
         response->error_msg = "field not found";
     } else {
-        response->value = m_stringBlackboard.find(request->field_name)->second;  
-        std::cout << "GetString: " << request->field_name << " " << response->value << std::endl; 
+        response->value = std::move(*value);
+        m_log->debug([&]() { return "GetString: " + request->field_name + " " + response->value; });
         response->is_ok = true;
     }
-    
 }
 
 void BlackboardComponent::SetString(const std::shared_ptr<blackboard_interfaces::srv::SetStringBlackboard::Request> request,
             std::shared_ptr<blackboard_interfaces::srv::SetStringBlackboard::Response>      response) 
 {
-    std::lock_guard<std::mutex> lock(m_mutexString);
     if (request->field_name == "") {
         response->is_ok = false;
         response->error_msg = "missing required field name";
@@ -138,11 +235,10 @@ void BlackboardComponent::SetString(const std::shared_ptr<blackboard_interfaces:
         response->is_ok = false;
         response->error_msg = "missing required value";
     } else {
-        if (m_stringBlackboard.contains(request->field_name)) {
+        if (m_store.set(request->field_name, request->value)) {
             response->error_msg = "field already present, overwriting";
-        } 
-        m_stringBlackboard.insert_or_assign(request->field_name, request->value);  
-        std::cout << "SetString: " << request->field_name << " " << request->value << std::endl;
+        }
+        m_log->debug([&]() { return "SetString: " + request->field_name + " " + request->value; });
         response->is_ok = true;
     }
 }
@@ -151,19 +247,18 @@ void BlackboardComponent::SetString(const std::shared_ptr<blackboard_interfaces:
 void BlackboardComponent::GetInt( const std::shared_ptr<blackboard_interfaces::srv::GetIntBlackboard::Request> request,
              std::shared_ptr<blackboard_interfaces::srv::GetIntBlackboard::Response>      response) 
 {
-    std::lock_guard<std::mutex> lock(m_mutexInt);
     if (request->field_name == "") {
         response->is_ok = false;
         response->error_msg = "missing required field name";
     } else {
-        if (!m_intBlackboard.contains(request->field_name)) {
+        auto value = m_store.get<int32_t>(request->field_name);
+        response->field_name = request->field_name;
+        if (!value) {
             response->is_ok = false;
             response->error_msg = "field not found";
-            response->field_name = request->field_name;
         } else {
-            response->field_name = request->field_name;
-            response->value = m_intBlackboard.find(request->field_name)->second; 
-            std::cout << "GetInt: " << request->field_name << " " << response->value << std::endl; 
+            response->value = *value;
+            m_log->debug([&]() { return "GetInt: " + request->field_name + " " + std::to_string(response->value); });
             response->is_ok = true;
         }
     }
@@ -173,16 +268,14 @@ void BlackboardComponent::GetInt( const std::shared_ptr<blackboard_interfaces::s
 void BlackboardComponent::SetInt( const std::shared_ptr<blackboard_interfaces::srv::SetIntBlackboard::Request> request,
              std::shared_ptr<blackboard_interfaces::srv::SetIntBlackboard::Response>      response) 
 {
-    std::lock_guard<std::mutex> lock(m_mutexInt);
     if (request->field_name == "") {
         response->is_ok = false;
         response->error_msg = "missing required field name";
     } else {
-        if (m_intBlackboard.contains(request->field_name)) {
+        if (m_store.set(request->field_name, request->value)) {
             response->error_msg = "field already present, overwriting";
-        } 
-        m_intBlackboard.insert_or_assign(request->field_name, request->value); 
-        std::cout << "SetInt: " << request->field_name << " " << request->value << std::endl; 
+        }
+        m_log->debug([&]() { return "SetInt: " + request->field_name + " " + std::to_string(request->value); });
         response->is_ok = true;
     }
 }
@@ -190,27 +283,98 @@ void BlackboardComponent::SetInt( const std::shared_ptr<blackboard_interfaces::s
 void BlackboardComponent::SetAllIntsWithPrefix(const std::shared_ptr<blackboard_interfaces::srv::SetAllIntsWithPrefixBlackboard::Request> request,
     std::shared_ptr<blackboard_interfaces::srv::SetAllIntsWithPrefixBlackboard::Response> response) 
 {
-    std::lock_guard<std::mutex> lock(m_mutexInt);
-    std::string prefix = request->field_name;
+    const std::string& prefix = request->field_name;
     if (prefix.empty()) {
         response->is_ok = false;
         response->error_msg = "Field name is empty";
         return;
     }
     
-    bool foundAny = false;
-    for (auto& [key, value] : m_intBlackboard) {
-        if (key.find(prefix) == 0) {
-            foundAny = true;
-            value = request->value; 
-            std::cout << "SetAllIntsWithPrefix: " << key << " " << request->value << std::endl;
-        }
-    }
+    size_t count = m_store.setAllWithPrefix(prefix, request->value);
+    m_log->debug([&]() { return "SetAllIntsWithPrefix: " + prefix + "* " + std::to_string(request->value) + " (" + std::to_string(count) + " fields)"; });
     
-    if (!foundAny) {
+    if (count == 0) {
         response->is_ok = false;
         response->error_msg = "No fields with the given prefix found";
     } else {
         response->is_ok = true;
     }
-}
\ No newline at end of file
+}
+
+void BlackboardComponent::GetMany(const std::shared_ptr<blackboard_interfaces::srv::GetManyBlackboard::Request> request,
+    std::shared_ptr<blackboard_interfaces::srv::GetManyBlackboard::Response> response)
+{
+    std::vector<BlackboardKey> keys;
+    keys.reserve(request->entries.size());
+    for (const auto& entry : request->entries) {
+        if (!checkEntry(entry, false, response->error_msg)) {
+            response->is_ok = false;
+            return;
+        }
+        keys.emplace_back(entry.field_name, entry.type);
+    }
+    auto values = m_store.getMany(keys);
+    response->entries = request->entries;
+    response->found.resize(values.size());
+    response->is_ok = true;
+    for (size_t i = 0; i < values.size(); i++) {
+        response->found[i] = values[i].has_value();
+        if (!values[i]) {
+            if (response->is_ok) {
+                response->error_msg = "field not found: " + request->entries[i].field_name;
+            }
+            response->is_ok = false;
+            continue;
+        }
+        setEntryValue(response->entries[i], *values[i]);
+    }
+    m_log->debug([&]() { return "GetMany: " + std::to_string(keys.size()) + " fields"; });
+}
+
+void BlackboardComponent::SetMany(const std::shared_ptr<blackboard_interfaces::srv::SetManyBlackboard::Request> request,
+    std::shared_ptr<blackboard_interfaces::srv::SetManyBlackboard::Response> response)
+{
+    // nothing is written unless every entry is valid
+    for (const auto& entry : request->entries) {
+        if (!checkEntry(entry, true, response->error_msg)) {
+            response->is_ok = false;
+            return;
+        }
+    }
+    m_store.setMany(entryFields(request->entries));
+    m_log->debug([&]() { return "SetMany: " + std::to_string(request->entries.size()) + " fields"; });
+    response->is_ok = true;
+}
+
+void BlackboardComponent::CompareAndSet(const std::shared_ptr<blackboard_interfaces::srv::CompareAndSetBlackboard::Request> request,
+    std::shared_ptr<blackboard_interfaces::srv::CompareAndSetBlackboard::Response> response)
+{
+    response->swapped = false;
+    for (const auto& entry : request->expected) {
+        if (!checkEntry(entry, false, response->error_msg)) {
+            response->is_ok = false;
+            return;
+        }
+    }
+    for (const auto& entry : request->entries) {
+        if (!checkEntry(entry, true, response->error_msg)) {
+            response->is_ok = false;
+            return;
+        }
+    }
+    std::vector<std::optional<BlackboardValue>> current;
+    response->is_ok = true;
+    response->swapped = m_store.compareAndSet(entryFields(request->expected), entryFields(request->entries), current);
+    if (!response->swapped) {
+        response->error_msg = "expected values do not hold";
+        response->current = request->expected;
+        response->found.resize(current.size());
+        for (size_t i = 0; i < current.size(); i++) {
+            response->found[i] = current[i].has_value();
+            if (current[i]) {
+                setEntryValue(response->current[i], *current[i]);
+            }
+        }
+    }
+    m_log->debug([&]() { return std::string("CompareAndSet: ") + (response->swapped ? "swapped" : "not swapped"); });
+}
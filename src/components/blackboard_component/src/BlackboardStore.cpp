@@ -0,0 +1,133 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2020 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+
+#include <mutex>
+#include <vector>
+
+#include "BlackboardStore.h"
+
+bool BlackboardStore::set(std::string_view name, BlackboardValue value)
+{
+    std::unique_lock lock(m_shards[shardIndex(name)].mutex);
+    return assign(name, std::move(value));
+}
+
+
+size_t BlackboardStore::setAllWithPrefix(std::string_view prefix, const BlackboardValue& value)
+{
+    // the matching fields can be in any shard: all of them are locked, in
+    // index order, before the first one is changed
+    std::vector<std::unique_lock<std::shared_mutex>> locks;
+    locks.reserve(SHARDS);
+    for (auto& shard : m_shards)
+    {
+        locks.emplace_back(shard.mutex);
+    }
+    size_t count = 0;
+    for (auto& shard : m_shards)
+    {
+        for (auto& [name, fieldValue] : shard.fields[value.index()])
+        {
+            if (std::string_view(name).substr(0, prefix.size()) == prefix)
+            {
+                fieldValue = value;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+
+std::vector<std::optional<BlackboardValue>> BlackboardStore::getMany(const std::vector<BlackboardKey>& keys) const
+{
+    std::array<bool, SHARDS> shards{};
+    for (const auto& [name, type] : keys)
+    {
+        shards[shardIndex(name)] = true;
+    }
+    auto locks = lockShards<std::shared_lock<std::shared_mutex>>(shards);
+    std::vector<std::optional<BlackboardValue>> values;
+    values.reserve(keys.size());
+    for (const auto& [name, type] : keys)
+    {
+        const BlackboardValue* value = find(name, type);
+        values.push_back(value ? std::optional<BlackboardValue>(*value) : std::nullopt);
+    }
+    return values;
+}
+
+
+void BlackboardStore::setMany(std::vector<BlackboardField> fields)
+{
+    std::array<bool, SHARDS> shards{};
+    for (const auto& field : fields)
+    {
+        shards[shardIndex(field.first)] = true;
+    }
+    auto locks = lockShards<std::unique_lock<std::shared_mutex>>(shards);
+    for (auto& [name, value] : fields)
+    {
+        assign(name, std::move(value));
+    }
+}
+
+
+bool BlackboardStore::compareAndSet(const std::vector<BlackboardField>& expected, std::vector<BlackboardField> fields,
+                                    std::vector<std::optional<BlackboardValue>>& current)
+{
+    std::array<bool, SHARDS> shards{};
+    for (const auto& field : expected)
+    {
+        shards[shardIndex(field.first)] = true;
+    }
+    for (const auto& field : fields)
+    {
+        shards[shardIndex(field.first)] = true;
+    }
+    auto locks = lockShards<std::unique_lock<std::shared_mutex>>(shards);
+    bool holds = true;
+    current.clear();
+    current.reserve(expected.size());
+    for (const auto& [name, value] : expected)
+    {
+        const BlackboardValue* found = find(name, value.index());
+        holds = holds && found && *found == value;
+        current.push_back(found ? std::optional<BlackboardValue>(*found) : std::nullopt);
+    }
+    if (!holds)
+    {
+        return false;
+    }
+    for (auto& [name, value] : fields)
+    {
+        assign(name, std::move(value));
+    }
+    return true;
+}
+
+
+const BlackboardValue* BlackboardStore::find(std::string_view name, size_t type) const
+{
+    const auto& fields = m_shards[shardIndex(name)].fields[type];
+    auto field = fields.find(name);
+    return field == fields.end() ? nullptr : &field->second;
+}
+
+
+bool BlackboardStore::assign(std::string_view name, BlackboardValue value)
+{
+    auto& fields = m_shards[shardIndex(name)].fields[value.index()];
+    auto field = fields.find(name);
+    if (field != fields.end())
+    {
+        field->second = std::move(value);
+        return true;
+    }
+    fields.emplace(std::string(name), std::move(value));
+    return false;
+}
@@ -8,6 +8,7 @@
 #include <mutex>
 #include <rclcpp/rclcpp.hpp>
 #include <std_msgs/msg/string.hpp>
+#include <std_msgs/msg/empty.hpp>
 #include <scheduler_interfaces/srv/update_poi.hpp>
 #include <scheduler_interfaces/srv/reset.hpp>
 #include <scheduler_interfaces/srv/end_tour.hpp>
@@ -36,6 +37,7 @@ public:
     bool close();
     void spin();
     void publisher(std::string text);
+    void notifyCurrentPoiChanged();
     void UpdatePoi([[maybe_unused]] const std::shared_ptr<scheduler_interfaces::srv::UpdatePoi::Request> request,
                 std::shared_ptr<scheduler_interfaces::srv::UpdatePoi::Response>      response);
     void GetCurrentPoi([[maybe_unused]] const std::shared_ptr<scheduler_interfaces::srv::GetCurrentPoi::Request> request,
@@ -76,6 +78,7 @@ private:
     rclcpp::Service<scheduler_interfaces::srv::GetAvailableCommands>::SharedPtr m_getAvailableCommandsService;
     rclcpp::Service<scheduler_interfaces::srv::SetPoi>::SharedPtr m_setPoiService;
     rclcpp::Publisher<std_msgs::msg::String>::SharedPtr m_publisher;
+    rclcpp::Publisher<std_msgs::msg::Empty>::SharedPtr m_currentPoiChangedPublisher;
 
 
     bool checkIfCommandValid(const std::string &poiName, const std::string command);
@@ -92,6 +92,8 @@ bool SchedulerComponent::start(int argc, char*argv[])
 
     RCLCPP_DEBUG(m_node->get_logger(), "SchedulerComponent::start");
     m_publisher = m_node->create_publisher<std_msgs::msg::String>("/LogComponent/add_to_log", 10);
+    // skills caching GetCurrentPoi drop their copy when this is published
+    m_currentPoiChangedPublisher = m_node->create_publisher<std_msgs::msg::Empty>("/SchedulerComponent/CurrentPoiChanged", 10);
     return true;
 
 }
@@ -114,6 +116,11 @@ void SchedulerComponent::publisher(std::string text)
     m_publisher->publish(msg);
 }
 
+void SchedulerComponent::notifyCurrentPoiChanged()
+{
+    m_currentPoiChangedPublisher->publish(std_msgs::msg::Empty());
+}
+
 void SchedulerComponent::Reset([[maybe_unused]] const std::shared_ptr<scheduler_interfaces::srv::Reset::Request> request,
              std::shared_ptr<scheduler_interfaces::srv::Reset::Response>      response)
 {
@@ -121,6 +128,7 @@ void SchedulerComponent::Reset([[maybe_unused]] const std::shared_ptr<scheduler_
     m_currentPoi = 0;
     m_currentAction = 0;
     response->is_ok = true;
+    notifyCurrentPoiChanged();
 }
 
 
@@ -131,6 +139,7 @@ void SchedulerComponent::EndTour([[maybe_unused]] const std::shared_ptr<schedule
     m_currentPoi = m_tourStorage->GetTour().getPoIsList().size() - 1;
     m_currentAction = 0;
     response->is_ok = true;
+    notifyCurrentPoiChanged();
 }
 
 void SchedulerComponent::UpdatePoi([[maybe_unused]] const std::shared_ptr<scheduler_interfaces::srv::UpdatePoi::Request> request,
@@ -140,6 +149,7 @@ void SchedulerComponent::UpdatePoi([[maybe_unused]] const std::shared_ptr<schedu
     m_currentPoi = (m_currentPoi + 1) % m_tourStorage->GetTour().getPoIsList().size();
     m_currentAction = 0;
     response->is_ok = true;
+    notifyCurrentPoiChanged();
     std::string text = "Update Poi to: " + std::to_string(m_currentPoi) + " - " + m_tourStorage->GetTour().getPoIsList()[m_currentPoi];
     publisher(text);
 }
@@ -154,6 +164,7 @@ void SchedulerComponent::SetPoi([[maybe_unused]] const std::shared_ptr<scheduler
     std::string text = "Update Poi to: " + std::to_string(m_currentPoi) + " - " + m_tourStorage->GetTour().getPoIsList()[m_currentPoi];
     if(old_poi_number != m_currentPoi)
     {
+        notifyCurrentPoiChanged();
         publisher(text);
     }
 }
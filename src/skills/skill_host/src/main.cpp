@@ -0,0 +1,77 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file main.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+#include <rclcpp/rclcpp.hpp>
+#include <ament_index_cpp/get_package_prefix.hpp>
+#include <SkillHost.h>
+#include <SkillPluginLoader.h>
+
+// a path to a plugin, or the package of a skill built with BUILD_SKILL_PLUGIN
+static std::string pluginPath(const std::string& skill)
+{
+    if (skill.find('/') != std::string::npos)
+    {
+        return skill;
+    }
+    try
+    {
+        return ament_index_cpp::get_package_prefix(skill) + "/lib/lib" + skill + "_plugin.so";
+    }
+    catch (const ament_index_cpp::PackageNotFoundError&)
+    {
+        return "lib" + skill + "_plugin.so";
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    rclcpp::init(argc, argv);
+    auto node = rclcpp::Node::make_shared("skill_host");
+    auto skills = node->declare_parameter<std::vector<std::string>>("skills", std::vector<std::string>());
+    auto threads = node->declare_parameter<int>("threads", 0);
+    if (skills.empty())
+    {
+        RCLCPP_ERROR(node->get_logger(), "No skill to host, set the skills parameter");
+        rclcpp::shutdown();
+        return 1;
+    }
+
+    // one executor and one Qt event loop for all the skills: each skill keeps
+    // its node and services, but no thread or context of its own
+    size_t threadCount = threads > 0 ? static_cast<size_t>(threads) : std::clamp(std::thread::hardware_concurrency(), 2u, 4u);
+    auto executor = std::make_shared<rclcpp::executors::MultiThreadedExecutor>(rclcpp::ExecutorOptions(), threadCount);
+    executor->add_node(node);
+    SkillHost::instance().open(executor);
+
+    SkillPluginLoader plugin_loader;
+    size_t failed = 0;
+    for (const auto& skill : skills)
+    {
+        if (!plugin_loader.load(pluginPath(skill)))
+        {
+            failed++;
+        }
+    }
+    RCLCPP_INFO(node->get_logger(), "Hosting %zu skills on %zu threads, %zu failed to load",
+                SkillHost::instance().nodeCount(), threadCount, failed);
+
+    executor->spin();
+
+    SkillHost::instance().close();
+    plugin_loader.stop();
+    rclcpp::shutdown();
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,3 @@
+# generator of the Qt-free state machines of the skills (see TableStateMachine.h):
+#   python3 ${skill_runtime_TABLE_SM_GENERATOR} <Skill>SM.scxml <output>/<Skill>SM.h
+set(skill_runtime_TABLE_SM_GENERATOR "${skill_runtime_DIR}/../scripts/generate_table_sm.py")
@@ -0,0 +1,154 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file AsyncComponentCall.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <rclcpp/rclcpp.hpp>
+
+/**
+ * One request of a skill to a component service, sent without blocking the
+ * thread submitting the event, which in skill_host is the thread shared by
+ * the state machines of all the skills. While the service is not available
+ * it is looked up again every second, up to timeout times; once sent, the
+ * response is awaited for timeout. done gets the response, or nullptr when
+ * either wait expires, on the thread of the executor spinning group.
+ */
+template <typename ServiceT>
+class AsyncComponentCall : public std::enable_shared_from_this<AsyncComponentCall<ServiceT>>
+{
+public:
+    using Response = typename ServiceT::Response;
+    using Done = std::function<void(std::shared_ptr<Response>)>;
+
+    static void send(std::shared_ptr<rclcpp::Node> node,
+                     rclcpp::CallbackGroup::SharedPtr group,
+                     typename rclcpp::Client<ServiceT>::SharedPtr client,
+                     std::shared_ptr<typename ServiceT::Request> request,
+                     std::chrono::seconds timeout,
+                     Done done)
+    {
+        std::shared_ptr<AsyncComponentCall> call(new AsyncComponentCall(std::move(node), std::move(group), std::move(client),
+                                                                         std::move(request), timeout, std::move(done)));
+        call->start();
+    }
+
+private:
+    AsyncComponentCall(std::shared_ptr<rclcpp::Node> node,
+                       rclcpp::CallbackGroup::SharedPtr group,
+                       typename rclcpp::Client<ServiceT>::SharedPtr client,
+                       std::shared_ptr<typename ServiceT::Request> request,
+                       std::chrono::seconds timeout,
+                       Done done) :
+            m_node(std::move(node)),
+            m_group(std::move(group)),
+            m_client(std::move(client)),
+            m_request(std::move(request)),
+            m_timeout(timeout),
+            m_done(std::move(done))
+    {
+    }
+
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_client->service_is_ready())
+        {
+            sendLocked();
+            return;
+        }
+        // the timers keep the call alive until it finishes
+        m_timer = m_node->create_wall_timer(std::chrono::seconds(1), [self = this->shared_from_this()]() { self->retry(); }, m_group);
+    }
+
+    void retry()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_finished)
+            {
+                return;
+            }
+            if (m_client->service_is_ready())
+            {
+                sendLocked();
+                return;
+            }
+            if (++m_retries < m_timeout.count())
+            {
+                return;
+            }
+        }
+        RCLCPP_ERROR(m_node->get_logger(), "Timed out while waiting for the service '%s'.", m_client->get_service_name());
+        finish(nullptr);
+    }
+
+    void sendLocked()
+    {
+        auto self = this->shared_from_this();
+        m_timer = m_node->create_wall_timer(m_timeout, [self]() { self->expire(); }, m_group);
+        m_requestId = m_client->async_send_request(m_request,
+            [self](typename rclcpp::Client<ServiceT>::SharedFuture future) { self->finish(future.get()); }).request_id;
+        m_sent = true;
+    }
+
+    void expire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_finished)
+            {
+                return;
+            }
+            if (m_sent)
+            {
+                m_client->remove_pending_request(m_requestId);
+            }
+        }
+        RCLCPP_ERROR(m_node->get_logger(), "Timed out while future complete for the service '%s'.", m_client->get_service_name());
+        finish(nullptr);
+    }
+
+    void finish(std::shared_ptr<Response> response)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_finished)
+            {
+                return;
+            }
+            m_finished = true;
+            if (m_timer)
+            {
+                m_timer->cancel();
+                m_timer.reset();
+            }
+        }
+        m_done(std::move(response));
+    }
+
+    std::shared_ptr<rclcpp::Node> m_node;
+    rclcpp::CallbackGroup::SharedPtr m_group;
+    typename rclcpp::Client<ServiceT>::SharedPtr m_client;
+    std::shared_ptr<typename ServiceT::Request> m_request;
+    std::chrono::seconds m_timeout;
+    Done m_done;
+    std::mutex m_mutex;
+    rclcpp::TimerBase::SharedPtr m_timer;
+    int64_t m_requestId{0};
+    bool m_sent{false};
+    bool m_finished{false};
+    int m_retries{0};
+};
@@ -0,0 +1,120 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file ComponentResponseCache.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <rclcpp/rclcpp.hpp>
+#include <rclcpp/serialization.hpp>
+
+struct ComponentCachePolicy
+{
+    const char* interfaceName;
+    const char* functionName;
+    int ttlMs;
+    const char* invalidatedBy;      // topic, empty when only the ttl applies
+    const char* invalidatedByType;
+};
+
+// the <cache> declarations of interfaces.xml, see generate_cache_policies.py
+const std::vector<ComponentCachePolicy>& componentCachePolicies();
+
+/**
+ * Process-wide read-through cache of the responses of the component
+ * services, used by the generated skills in front of their clients. Only the
+ * functions with a <cache> in interfaces.xml are cached: their successful
+ * responses are reused for ttl_ms, by every skill of the process, for the
+ * same request. When the policy names an invalidated_by topic, the first
+ * skill using the function subscribes to it on its node and every message
+ * drops the cached responses of that function. A skill calling any other
+ * function of the same interface drops them too, before it sees the reply.
+ */
+class ComponentResponseCache
+{
+public:
+    static ComponentResponseCache& instance();
+
+    // the cached response to request, or nullptr when it must be called
+    template <typename ServiceT>
+    std::shared_ptr<const typename ServiceT::Response> get(const std::shared_ptr<rclcpp::Node>& node,
+                                                           const std::string& interfaceName,
+                                                           const std::string& functionName,
+                                                           const typename ServiceT::Request& request)
+    {
+        if (!isCached(interfaceName, functionName))
+        {
+            return nullptr;
+        }
+        auto response = lookup(node, interfaceName + "/" + functionName, requestKey<ServiceT>(request));
+        return std::static_pointer_cast<const typename ServiceT::Response>(response);
+    }
+
+    template <typename ServiceT>
+    void put(const std::string& interfaceName,
+             const std::string& functionName,
+             const typename ServiceT::Request& request,
+             std::shared_ptr<const typename ServiceT::Response> response)
+    {
+        if (!isCached(interfaceName, functionName))
+        {
+            return;
+        }
+        store(interfaceName + "/" + functionName, requestKey<ServiceT>(request), std::move(response));
+    }
+
+    void invalidate(const std::string& interfaceName, const std::string& functionName);
+    // to be called after every request sent to the component: a function that
+    // is not cached may change what the getters of its interface return, so
+    // their cached responses are dropped
+    void invalidateGetters(const std::string& interfaceName, const std::string& calledFunction);
+    void invalidateAll();
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<const void> response;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    struct Function
+    {
+        std::chrono::milliseconds ttl;
+        std::string invalidatedBy;
+        std::string invalidatedByType;
+        rclcpp::GenericSubscription::SharedPtr subscription;
+        std::map<std::string, Entry> entries;
+    };
+
+    ComponentResponseCache();
+    bool isCached(const std::string& interfaceName, const std::string& functionName) const;
+    std::shared_ptr<const void> lookup(const std::shared_ptr<rclcpp::Node>& node, const std::string& function, const std::string& key);
+    void store(const std::string& function, const std::string& key, std::shared_ptr<const void> response);
+
+    // requests of the cached getters are small: their serialized form is the key
+    template <typename ServiceT>
+    static std::string requestKey(const typename ServiceT::Request& request)
+    {
+        static rclcpp::Serialization<typename ServiceT::Request> serialization;
+        rclcpp::SerializedMessage serialized;
+        serialization.serialize_message(&request, &serialized);
+        const auto& message = serialized.get_rcl_serialized_message();
+        return std::string(reinterpret_cast<const char*>(message.buffer), message.buffer_length);
+    }
+
+    std::mutex m_mutex;
+    // filled once in the constructor, read without the lock
+    std::map<std::string, Function> m_functions;
+};
@@ -0,0 +1,81 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file ServiceIntrospection.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <rclcpp/rclcpp.hpp>
+
+/**
+ * Chooses how much service introspection (<service>/_service_event) the
+ * clients and services of a node publish, so that only the events someone
+ * consumes are serialized a second time. The level comes from the node
+ * parameters, which can be changed at runtime:
+ *   service_introspection            default level (default "auto")
+ *   service_introspection_overrides  ["<service>=<level>", ...]
+ * with the levels
+ *   off        no events
+ *   metadata   events without the request and response contents
+ *   contents   full events, what the monitors of monitoring/ read
+ *   sampled:N  metadata for every call, contents for one call every N
+ *   auto       contents while the event topic has subscribers (checked at
+ *              most once per second), off otherwise
+ * apply() is called before each request, the endpoint is reconfigured only
+ * when its state changes.
+ */
+class ServiceIntrospection
+{
+public:
+    explicit ServiceIntrospection(std::shared_ptr<rclcpp::Node> node);
+
+    template <typename EndpointT>
+    void apply(EndpointT& endpoint, const std::string& service)
+    {
+        rcl_service_introspection_state_t state;
+        if (nextState(service, state))
+        {
+            endpoint.configure_introspection(m_node->get_clock(), rclcpp::SystemDefaultsQoS(), state);
+        }
+    }
+
+private:
+    enum class Mode { OFF, METADATA, CONTENTS, SAMPLED, AUTO };
+
+    struct Level
+    {
+        Mode mode{Mode::AUTO};
+        unsigned sampleEvery{1};
+    };
+
+    struct Endpoint
+    {
+        bool configured{false};
+        rcl_service_introspection_state_t state{RCL_SERVICE_INTROSPECTION_OFF};
+        unsigned calls{0};
+        std::chrono::steady_clock::time_point subscribersCheckedAt;
+        bool hasSubscribers{false};
+    };
+
+    static bool parseLevel(const std::string& text, Level& level);
+    rcl_interfaces::msg::SetParametersResult onParameters(const std::vector<rclcpp::Parameter>& parameters);
+    // true when the endpoint of service has to be reconfigured to state
+    bool nextState(const std::string& service, rcl_service_introspection_state_t& state);
+
+    std::shared_ptr<rclcpp::Node> m_node;
+    rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr m_parametersCallback;
+    std::mutex m_mutex;
+    Level m_default;
+    std::map<std::string, Level> m_overrides;
+    std::map<std::string, Endpoint> m_endpoints;
+};
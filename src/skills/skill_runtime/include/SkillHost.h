@@ -0,0 +1,50 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file SkillHost.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <rclcpp/rclcpp.hpp>
+
+/**
+ * Process-wide executor shared by the skills loaded in a skill_host process.
+ * skill_host opens it before loading the skill plugins; a skill that finds
+ * it open adds its node here instead of spinning it on a thread of its own,
+ * so all the skills of the process are served by the same executor threads.
+ * The callback groups of their component clients are not spun there but by
+ * one more executor with a thread of its own: a skill waiting for a
+ * component inside its tick callback gets the response even when every
+ * thread of the shared executor is busy in a tick.
+ * In a standalone skill executable it is never opened and add() returns
+ * false.
+ */
+class SkillHost
+{
+public:
+    static SkillHost& instance();
+    void open(std::shared_ptr<rclcpp::Executor> executor);
+    // clientGroup must be created without adding it to the executor with node
+    bool add(std::shared_ptr<rclcpp::Node> node, rclcpp::CallbackGroup::SharedPtr clientGroup = nullptr);
+    void close();
+    size_t nodeCount();
+
+private:
+    SkillHost() = default;
+
+    std::mutex m_mutex;
+    std::shared_ptr<rclcpp::Executor> m_executor;
+    std::vector<std::shared_ptr<rclcpp::Node>> m_nodes;
+    std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> m_clientExecutor;
+    std::thread m_clientThread;
+};
@@ -0,0 +1,54 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file SkillPluginLoader.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class QCoreApplication;
+
+#define SKILL_PLUGIN_ENTRY "createSkillPlugin"
+#define SKILL_PLUGIN_EXIT "destroySkillPlugin"
+
+/**
+ * Loads skills built as plugins (lib<skill>_plugin.so) into the current
+ * process. The state machines of the skills need a Qt event loop, which is
+ * started on a dedicated thread when the process does not have one; each
+ * plugin is created on that thread and registers itself in the
+ * SkillTickRegistry, where the tree leaves find it.
+ * stop() destroys the skills, on the same thread, before stopping the event
+ * loop. The libraries are never unloaded, not even the ones whose skill
+ * failed to start: that skill may already have registered callbacks.
+ */
+class SkillPluginLoader
+{
+public:
+    SkillPluginLoader() = default;
+    ~SkillPluginLoader();
+    bool load(const std::string& path);
+    void stop();
+
+private:
+    bool startEventLoop();
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    QCoreApplication* m_app{nullptr};
+    bool m_ownsApp{false};
+    std::shared_ptr<std::thread> m_threadQt;
+    std::vector<void*> m_handles;
+    std::vector<void (*)()> m_destroys;
+};
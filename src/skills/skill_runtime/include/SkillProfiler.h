@@ -0,0 +1,77 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file SkillProfiler.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <rclcpp/rclcpp.hpp>
+#include <std_srvs/srv/trigger.hpp>
+
+/**
+ * Latencies in power of two buckets of microseconds: bucket 0 counts the
+ * values below 1us, bucket i the values in [2^(i-1), 2^i) us, the last one
+ * everything above. Every skill uses the same buckets, so histograms of
+ * different skills add up bucket by bucket.
+ */
+class SkillLatencyHistogram
+{
+public:
+    static constexpr size_t BUCKETS = 32;
+
+    void record(std::chrono::steady_clock::duration latency);
+    void appendJson(std::string& out) const;
+
+private:
+    uint64_t m_count{0};
+    uint64_t m_totalUs{0};
+    uint64_t m_minUs{UINT64_MAX};
+    uint64_t m_maxUs{0};
+    std::array<uint64_t, BUCKETS> m_buckets{};
+};
+
+
+/**
+ * In-memory profile of a skill: how long its state machine dwells in each
+ * state, how often each transition is taken and how long each component
+ * call takes from request to return. The skill feeds it from the state
+ * change notifications of its state machine and from its component
+ * handlers; the profile is served as JSON by the std_srvs/Trigger service
+ * <skill>/stats, see scripts/aggregate_skill_stats.py to merge the profiles
+ * of all the running skills.
+ */
+class SkillProfiler
+{
+public:
+    SkillProfiler(std::shared_ptr<rclcpp::Node> node, const std::string& skillName);
+
+    void stateChanged(const std::string& state, bool active);
+    void recordCall(const std::string& interface, std::chrono::steady_clock::duration latency);
+    std::string toJson() const;
+
+private:
+    void onStats(const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
+                 std::shared_ptr<std_srvs::srv::Trigger::Response> response);
+
+    std::string m_skillName;
+    rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr m_statsService;
+    mutable std::mutex m_mutex;
+    std::chrono::steady_clock::time_point m_startedAt;
+    std::map<std::string, std::chrono::steady_clock::time_point> m_enteredAt;
+    std::string m_lastExited;
+    std::map<std::string, SkillLatencyHistogram> m_states;
+    std::map<std::string, uint64_t> m_transitions;
+    std::map<std::string, SkillLatencyHistogram> m_calls;
+};
@@ -0,0 +1,71 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file SkillTickRegistry.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <rclcpp/rclcpp.hpp>
+#include <bt_interfaces_dummy/srv/tick_batch.hpp>
+
+/**
+ * Process-wide table of the skills running in this process, indexed by the
+ * name used in their <name>Skill/tick service. It serves <host>/TickBatch,
+ * which ticks all the requested skills concurrently on a fixed pool of
+ * worker threads, started with the first service, and answers with all
+ * their statuses in one response. Batching is opt-in: a skill serves the
+ * batch only when its tick_batch_host parameter is set, and the conditions
+ * of the tree use it only when they declare the same host. Leaves running
+ * in the same process (skill plugins loaded by the tree) call tick() and
+ * halt() directly instead.
+ */
+class SkillTickRegistry
+{
+public:
+    using TickFunction = std::function<int8_t()>;
+    using HaltFunction = std::function<void()>;
+
+    static SkillTickRegistry& instance();
+    void registerSkill(const std::string& name, TickFunction tick);
+    void registerHalt(const std::string& name, HaltFunction halt);
+    void unregisterSkill(const std::string& name);
+    bool contains(const std::string& name);
+    bool tick(const std::string& name, int8_t& status);
+    bool halt(const std::string& name);
+    bool serveBatch(std::shared_ptr<rclcpp::Node> node, const std::string& host);
+
+private:
+    SkillTickRegistry() = default;
+    ~SkillTickRegistry();
+    void startWorkers();
+    void work();
+    void tickBatch(const std::shared_ptr<bt_interfaces_dummy::srv::TickBatch::Request> request,
+                   std::shared_ptr<bt_interfaces_dummy::srv::TickBatch::Response> response);
+
+    std::mutex m_mutex;
+    std::map<std::string, TickFunction> m_skills;
+    std::map<std::string, HaltFunction> m_halts;
+    std::map<std::string, rclcpp::Service<bt_interfaces_dummy::srv::TickBatch>::SharedPtr> m_batchServices;
+
+    // the ticks of the batches waiting for a worker
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueCondition;
+    std::deque<std::packaged_task<int8_t()>> m_queue;
+    bool m_stopping{false};
+    std::vector<std::thread> m_workers;
+};
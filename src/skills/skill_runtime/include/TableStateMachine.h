@@ -0,0 +1,183 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TableStateMachine.h
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/**
+ * Value of a datamodel member or of an event field, the Qt-free counterpart
+ * of the QVariant used by the Qt SCXML backend. Conversions follow QVariant:
+ * "false", "0" and "" are false, numbers print without trailing zeros.
+ */
+class SkillValue
+{
+public:
+    SkillValue() = default;
+    SkillValue(bool value) : m_value(value) {}
+    template <typename T, typename std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+    SkillValue(T value) : m_value(static_cast<int64_t>(value)) {}
+    template <typename T, typename std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+    SkillValue(T value) : m_value(static_cast<double>(value)) {}
+    SkillValue(const char* value) : m_value(std::string(value)) {}
+    SkillValue(std::string value) : m_value(std::move(value)) {}
+
+    bool isNull() const;
+    bool toBool() const;
+    int toInt() const;
+    double toDouble() const;
+    std::string toString() const;
+    bool operator==(const SkillValue& other) const;
+    bool operator!=(const SkillValue& other) const { return !(*this == other); }
+
+private:
+    std::variant<std::monostate, bool, int64_t, double, std::string> m_value;
+};
+
+
+/**
+ * Fields of an event, the counterpart of the QVariantMap submitted to a
+ * QScxmlStateMachine. Events carry a handful of fields, a vector is cheaper
+ * than a map.
+ */
+class SkillEventData
+{
+public:
+    void insert(const std::string& field, SkillValue value);
+    SkillValue value(std::string_view field) const;
+
+private:
+    std::vector<std::pair<std::string, SkillValue>> m_fields;
+};
+
+
+class SkillEvent
+{
+public:
+    SkillEvent() = default;
+    SkillEvent(std::string name, SkillEventData data) : m_name(std::move(name)), m_data(std::move(data)) {}
+    const std::string& name() const { return m_name; }
+    const SkillEventData& data() const { return m_data; }
+
+private:
+    std::string m_name;
+    SkillEventData m_data;
+};
+
+
+/**
+ * Qt-free runtime of the state machines generated by generate_table_sm.py.
+ * The generated class describes the machine with constexpr tables (states,
+ * events, transitions in document order) and implements guard() and
+ * action() as switches over compiled C++; this class only walks the tables.
+ *
+ * There is no event loop: submitEvent() queues the event and, unless another
+ * thread is already doing it, processes the queue to completion on the
+ * calling thread. Events sent by the machine are delivered to the listeners
+ * registered with connectToEvent() after each macrostep, outside the lock,
+ * on the same thread; the events they submit are processed by the same loop,
+ * so the listeners see the same ordering as with the Qt event loop.
+ * Only flat machines are supported: states without children, transitions
+ * with at most one target, no delayed sends.
+ */
+class TableStateMachine
+{
+public:
+    static constexpr int16_t NONE = -1;
+
+    struct State
+    {
+        const char* name;
+        int16_t onEntry;          // action id or NONE
+        int16_t onExit;           // action id or NONE
+        int16_t firstTransition;  // rows of this state in the transition table
+        int16_t transitionCount;
+    };
+
+    struct Transition
+    {
+        int16_t event;   // index in the event table, NONE for eventless transitions
+        int16_t guard;   // guard id or NONE
+        int16_t target;  // state index, NONE for targetless transitions
+        int16_t action;  // action id or NONE
+    };
+
+    using Listener = std::function<void(const SkillEvent&)>;
+    using StateListener = std::function<void(bool active)>;
+
+    TableStateMachine(const State* states, size_t stateCount,
+                      const Transition* transitions,
+                      const char* const* events, size_t eventCount,
+                      int16_t initialState);
+    virtual ~TableStateMachine() = default;
+
+    bool start();
+    bool isRunning() const;
+    void submitEvent(const std::string& name, SkillEventData data = {});
+    void connectToEvent(const std::string& name, Listener listener);
+    std::string activeStateName() const;
+    std::vector<std::string> stateNames() const;
+    // like QScxmlStateMachine::connectToState, to be called before start()
+    bool connectToState(const std::string& name, StateListener listener);
+
+protected:
+    virtual bool guard(int id) = 0;
+    virtual void action(int id) = 0;
+    virtual void log(const std::string& label, const std::string& message);
+
+    // for the generated actions: <send> and <raise>
+    void send(const std::string& name, SkillEventData data = {});
+    void raise(const std::string& name, SkillEventData data = {});
+    // _event.data.<field> of the event being processed
+    SkillValue eventData(const std::string& field) const;
+
+private:
+    int16_t eventIndex(const std::string& name) const;
+    void processQueue(std::unique_lock<std::mutex>& lock);
+    void macrostep(const SkillEvent& event);
+    bool takeTransition(int16_t event);
+    void enterState(int16_t state);
+    void notifyState(int16_t state, bool active);
+
+    const State* m_states;
+    size_t m_stateCount;
+    const Transition* m_transitions;
+    const char* const* m_events;
+    size_t m_eventCount;
+    int16_t m_initialState;
+
+    mutable std::mutex m_mutex;
+    std::deque<SkillEvent> m_externalQueue;
+    bool m_processing{false};
+    bool m_running{false};
+    std::atomic<int16_t> m_activeState{NONE};
+
+    // only touched by the thread processing the queue
+    const SkillEvent* m_currentEvent{nullptr};
+    std::deque<SkillEvent> m_internalQueue;
+    std::vector<SkillEvent> m_outgoing;
+
+    std::mutex m_listenersMutex;
+    std::map<std::string, std::vector<Listener>> m_listeners;
+    // by state index, only read by the thread processing the queue after start()
+    std::vector<std::vector<StateListener>> m_stateListeners;
+};
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""
+Collects the profiles of the skills built with SKILL_PROFILING and merges
+them into one report.
+
+Usage: aggregate_skill_stats.py [--json] [--timeout <s>] [dump.json ...]
+
+Without files it calls every std_srvs/srv/Trigger service named
+<skill>/stats on the ROS graph; files are dumps saved from those services
+(the message field of the response, one JSON object per file or per line).
+The report lists, for every skill, the dwell time in each state, the
+transitions taken and the latency of each component call; --json prints the
+merged profile instead. Histograms use the power of two buckets of
+SkillLatencyHistogram (skill_runtime), so profiles of the same skill coming
+from several runs add up bucket by bucket.
+"""
+
+import argparse
+import json
+import sys
+
+
+def merge_histogram(into, histogram):
+    if not into:
+        into.update(json.loads(json.dumps(histogram)))
+        return
+    if into["count"] == 0:
+        into["min_us"] = histogram["min_us"]
+    elif histogram["count"] > 0:
+        into["min_us"] = min(into["min_us"], histogram["min_us"])
+    into["count"] += histogram["count"]
+    into["total_us"] += histogram["total_us"]
+    into["max_us"] = max(into["max_us"], histogram["max_us"])
+    into["buckets"] = [a + b for a, b in zip(into["buckets"], histogram["buckets"])]
+
+
+def merge(profiles):
+    skills = {}
+    for profile in profiles:
+        skill = skills.setdefault(profile["skill"], {"skill": profile["skill"], "uptime_us": 0,
+                                                     "buckets": profile["buckets"], "active": {},
+                                                     "states": {}, "transitions": {}, "calls": {}})
+        skill["uptime_us"] += profile["uptime_us"]
+        skill["active"].update(profile["active"])
+        for key in ("states", "calls"):
+            for name, histogram in profile[key].items():
+                merge_histogram(skill[key].setdefault(name, {}), histogram)
+        for name, count in profile["transitions"].items():
+            skill["transitions"][name] = skill["transitions"].get(name, 0) + count
+    return [skills[name] for name in sorted(skills)]
+
+
+def percentile(histogram, fraction):
+    # upper bound of the bucket holding the percentile, in microseconds
+    target = fraction * histogram["count"]
+    seen = 0
+    for bucket, count in enumerate(histogram["buckets"]):
+        seen += count
+        if count and seen >= target:
+            return min(1 << bucket, histogram["max_us"]) if bucket else 1
+    return histogram["max_us"]
+
+
+def ms(us):
+    return "%.1f" % (us / 1000.0)
+
+
+def print_histograms(title, histograms):
+    if not histograms:
+        return
+    print("  %-40s %8s %10s %10s %10s %10s" % (title, "count", "total ms", "mean ms", "p99 ms", "max ms"))
+    for name, histogram in sorted(histograms.items(), key=lambda item: -item[1]["total_us"]):
+        count = histogram["count"]
+        mean = histogram["total_us"] / count if count else 0
+        print("  %-40s %8d %10s %10s %10s %10s" % (name, count, ms(histogram["total_us"]), ms(mean),
+                                                   ms(percentile(histogram, 0.99)), ms(histogram["max_us"])))
+
+
+def report(skills):
+    for skill in skills:
+        print("%s (uptime %s ms)" % (skill["skill"], ms(skill["uptime_us"])))
+        print_histograms("state", skill["states"])
+        for name, elapsed in sorted(skill["active"].items()):
+            print("  active %s since %s ms" % (name, ms(elapsed)))
+        for name, count in sorted(skill["transitions"].items(), key=lambda item: -item[1]):
+            print("  %-40s %8d" % (name, count))
+        print_histograms("call", skill["calls"])
+        print()
+
+
+def read_files(paths):
+    profiles = []
+    for path in paths:
+        with open(path) as handle:
+            text = handle.read().strip()
+        try:
+            profiles.append(json.loads(text))
+        except json.JSONDecodeError:
+            profiles.extend(json.loads(line) for line in text.splitlines() if line.strip())
+    return profiles
+
+
+def query_services(timeout):
+    import rclpy
+    from std_srvs.srv import Trigger
+
+    rclpy.init()
+    node = rclpy.create_node("aggregate_skill_stats")
+    try:
+        # let discovery fill the graph before listing the services
+        end = node.get_clock().now().nanoseconds + int(timeout * 1e9)
+        while node.get_clock().now().nanoseconds < end:
+            rclpy.spin_once(node, timeout_sec=0.1)
+        profiles = []
+        for name, types in node.get_service_names_and_types():
+            if not name.endswith("/stats") or "std_srvs/srv/Trigger" not in types:
+                continue
+            client = node.create_client(Trigger, name)
+            future = client.call_async(Trigger.Request())
+            rclpy.spin_until_future_complete(node, future, timeout_sec=timeout)
+            if future.result() is None or not future.result().success:
+                print("%s: no answer" % name, file=sys.stderr)
+                continue
+            profiles.append(json.loads(future.result().message))
+        return profiles
+    finally:
+        node.destroy_node()
+        rclpy.shutdown()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--json", action="store_true", help="print the merged profiles as JSON")
+    parser.add_argument("--timeout", type=float, default=2.0, help="seconds for discovery and for each call")
+    parser.add_argument("dumps", nargs="*")
+    args = parser.parse_args()
+    profiles = read_files(args.dumps) if args.dumps else query_services(args.timeout)
+    if not profiles:
+        print("no skill profiles found", file=sys.stderr)
+        return 1
+    skills = merge(profiles)
+    if args.json:
+        json.dump(skills, sys.stdout, indent=2)
+        print()
+    else:
+        report(skills)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
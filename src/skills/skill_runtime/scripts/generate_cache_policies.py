@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""
+Collects the <cache> declarations of interfaces.xml into the table of
+ComponentResponseCache (skill_runtime).
+
+Usage: generate_cache_policies.py <interfaces.xml> <output>.cpp
+
+A function declares that the skills may reuse its responses with
+    <function id="GetCurrentPoi">
+        ...
+        <cache ttl_ms="1000" invalidated_by="/SchedulerComponent/CurrentPoiChanged"
+               invalidated_by_type="std_msgs/msg/Empty"/>
+    </function>
+ttl_ms is how long a response is reused, invalidated_by an optional topic
+whose messages drop the cached responses (invalidated_by_type defaults to
+std_msgs/msg/Empty). Functions without <cache> are always called.
+"""
+
+import argparse
+import os
+import sys
+import xml.etree.ElementTree as ET
+
+
+def local(tag):
+    return tag.rsplit("}", 1)[-1] if isinstance(tag, str) else None
+
+
+def quoted(text):
+    return '"%s"' % text.replace("\\", "\\\\").replace('"', '\\"')
+
+
+def policies(root):
+    rows = []
+    for interface in root.iter():
+        if local(interface.tag) != "interface" or not interface.get("id"):
+            continue
+        for function in interface:
+            if local(function.tag) != "function":
+                continue
+            for cache in function:
+                if local(cache.tag) != "cache":
+                    continue
+                ttl = int(cache.get("ttl_ms", "0"))
+                if ttl <= 0:
+                    raise ValueError("%s/%s: ttl_ms must be positive" % (interface.get("id"), function.get("id")))
+                topic = cache.get("invalidated_by", "")
+                topic_type = cache.get("invalidated_by_type", "std_msgs/msg/Empty") if topic else ""
+                rows.append("{%s, %s, %d, %s, %s}" % (quoted(interface.get("id")), quoted(function.get("id")),
+                                                       ttl, quoted(topic), quoted(topic_type)))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("interfaces")
+    parser.add_argument("output")
+    args = parser.parse_args()
+    try:
+        rows = policies(ET.parse(args.interfaces).getroot())
+    except (ET.ParseError, ValueError) as error:
+        print("%s: %s" % (args.interfaces, error), file=sys.stderr)
+        return 1
+    source = "// generated by generate_cache_policies.py from %s, do not edit\n\n" % os.path.basename(args.interfaces)
+    source += "#include <ComponentResponseCache.h>\n\n"
+    source += "const std::vector<ComponentCachePolicy>& componentCachePolicies()\n{\n"
+    source += "    static const std::vector<ComponentCachePolicy> policies = {\n"
+    source += "".join("        %s,\n" % row for row in rows)
+    source += "    };\n    return policies;\n}\n"
+    if os.path.exists(args.output):
+        with open(args.output) as handle:
+            if handle.read() == source:
+                return 0
+    with open(args.output, "w") as handle:
+        handle.write(source)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+"""
+Compiles the state machine of a skill into a C++ header for the Qt-free
+TableStateMachine runtime of skill_runtime.
+
+Usage: generate_table_sm.py <Skill>SM.scxml <output directory>/<Skill>SM.h
+
+The header declares the class named by the name attribute of <scxml>, the
+same class qt6_add_statecharts generates, so the skill code does not change:
+states, events and transitions become constexpr tables, guards and
+executable content become two switches of compiled C++. The input must use
+the ECMAScript datamodel (generate_all_skills.sh with DATAMODEL=ecmascript)
+and only flat machines are accepted; anything else is reported and the exit
+code is 1.
+"""
+
+import argparse
+import os
+import sys
+import xml.etree.ElementTree as ET
+
+from scxml_expressions import (NS, BOOL, STRING, STD_DIALECT, Translator, Unsupported,
+                               infer_members, member_declarations)
+
+STATE_CHILDREN = ("onentry", "onexit", "transition")
+SEND_ATTRIBUTES = ("event", "id")
+
+
+def tag(element):
+    return element.tag.replace(NS, "")
+
+
+def quoted(text):
+    return '"%s"' % text.replace("\\", "\\\\").replace('"', '\\"')
+
+
+class TableGenerator:
+    def __init__(self, root):
+        if root.tag != NS + "scxml":
+            raise Unsupported("not an SCXML document")
+        datamodel = root.get("datamodel", "ecmascript")
+        if datamodel != "ecmascript":
+            raise Unsupported("datamodel '%s', generate the skill with DATAMODEL=ecmascript" % datamodel)
+        if not root.get("name"):
+            raise Unsupported("the <scxml> element has no name")
+        self.root = root
+        self.members = infer_members(root)
+        self.translator = Translator({name: kind for name, (kind, _) in self.members.items()}, STD_DIALECT)
+        self.states = []
+        self.events = []
+        self.guards = []
+        self.actions = []
+
+    # ------------------------------------------------------------ tables
+
+    def generate(self):
+        for child in self.root:
+            if not isinstance(child.tag, str) or tag(child) == "datamodel":
+                continue
+            if tag(child) != "state":
+                raise Unsupported("<%s> at the top level, only flat <state>s are supported" % tag(child))
+            self.states.append(child)
+        if not self.states:
+            raise Unsupported("no states")
+        names = [state.get("id") for state in self.states]
+        initial = self.root.get("initial", names[0])
+        if initial not in names:
+            raise Unsupported("initial state '%s' is not a top level state" % initial)
+
+        state_rows = []
+        transition_rows = []
+        for state in self.states:
+            on_entry = []
+            on_exit = []
+            transitions = []
+            for child in state:
+                if not isinstance(child.tag, str):
+                    continue
+                if tag(child) not in STATE_CHILDREN:
+                    raise Unsupported("<%s> in state '%s', only flat states are supported" % (tag(child), state.get("id")))
+                {"onentry": on_entry, "onexit": on_exit, "transition": transitions}[tag(child)].append(child)
+            first = len(transition_rows)
+            for transition in transitions:
+                transition_rows.extend(self.transition_rows(transition, names))
+            state_rows.append("{%s, %s, %s, %d, %d}" % (quoted(state.get("id")),
+                                                         self.action_id(on_entry), self.action_id(on_exit),
+                                                         first, len(transition_rows) - first))
+        return self.header(names.index(initial), state_rows, transition_rows)
+
+    def transition_rows(self, transition, names):
+        target = transition.get("target")
+        if target is not None and target not in names:
+            raise Unsupported("transition to '%s', only single top level targets are supported" % target)
+        guard = "NONE"
+        if transition.get("cond"):
+            guard = self.index(self.guards, self.translator.typed(transition.get("cond"), BOOL))
+        action = self.action_id([transition])
+        target_index = "NONE" if target is None else str(names.index(target))
+        descriptors = (transition.get("event") or "").split()
+        rows = []
+        for event in descriptors or [None]:
+            if event is not None and ("*" in event or event.endswith(".")):
+                raise Unsupported("event descriptor '%s', only exact event names are supported" % event)
+            event_index = "NONE" if event is None else self.index(self.events, event)
+            rows.append("{%s, %s, %s, %s}" % (event_index, guard, target_index, action))
+        return rows
+
+    @staticmethod
+    def index(table, entry):
+        if entry not in table:
+            table.append(entry)
+        return str(table.index(entry))
+
+    def action_id(self, containers):
+        lines = []
+        for container in containers:
+            lines.extend(self.statements(container, "            "))
+        if not lines:
+            return "NONE"
+        return self.index(self.actions, "\n".join(lines))
+
+    # ------------------------------------------------------------ executable content
+
+    def statements(self, container, indent):
+        lines = []
+        for element in container:
+            if not isinstance(element.tag, str):
+                continue
+            lines.extend(self.statement(element, indent))
+        return lines
+
+    def statement(self, element, indent):
+        translator = self.translator
+        name = tag(element)
+        if name == "assign":
+            location = element.get("location")
+            kind = translator.members[location]
+            return ["%s%s = %s;" % (indent, location, translator.typed(element.get("expr") or "", kind))]
+        if name == "log":
+            message = translator.typed(element.get("expr"), STRING) if element.get("expr") else "std::string()"
+            return ["%slog(%s, %s);" % (indent, quoted(element.get("label") or ""), message)]
+        if name == "raise":
+            return ["%sraise(%s);" % (indent, quoted(element.get("event")))]
+        if name == "send":
+            return self.send(element, indent)
+        if name == "if":
+            return self.conditional(element, indent)
+        raise Unsupported("<%s> element" % name)
+
+    def send(self, element, indent):
+        for attribute in element.attrib:
+            if attribute not in SEND_ATTRIBUTES:
+                raise Unsupported("'%s' attribute on <send>" % attribute)
+        params = []
+        for child in element:
+            if not isinstance(child.tag, str):
+                continue
+            if tag(child) != "param" or child.get("location"):
+                raise Unsupported("<%s> in <send>, only <param expr> is supported" % tag(child))
+            params.append((child.get("name"), self.translator.value(child.get("expr") or "")))
+        event = quoted(element.get("event"))
+        if not params:
+            return ["%ssend(%s);" % (indent, event)]
+        lines = ["%s{" % indent, "%s    SkillEventData data;" % indent]
+        lines.extend("%s    data.insert(%s, %s);" % (indent, quoted(name), value) for name, value in params)
+        lines.append("%s    send(%s, std::move(data));" % (indent, event))
+        lines.append("%s}" % indent)
+        return lines
+
+    def conditional(self, element, indent):
+        # <if> holds its branches flat: <elseif/> and <else/> only separate them
+        branches = [["if", element.get("cond"), []]]
+        for child in element:
+            if not isinstance(child.tag, str):
+                continue
+            if tag(child) == "elseif":
+                branches.append(["else if", child.get("cond"), []])
+            elif tag(child) == "else":
+                branches.append(["else", None, []])
+            else:
+                branches[-1][2].append(child)
+        lines = []
+        for keyword, cond, children in branches:
+            if cond is None:
+                lines.append("%s%s" % (indent, keyword))
+            else:
+                lines.append("%s%s (%s)" % (indent, keyword, self.translator.typed(cond, BOOL)))
+            lines.append("%s{" % indent)
+            for child in children:
+                lines.extend(self.statement(child, indent + "    "))
+            lines.append("%s}" % indent)
+        return lines
+
+    # ------------------------------------------------------------ output
+
+    def header(self, initial, state_rows, transition_rows):
+        class_name = self.root.get("name")
+        guard_cases = "\n".join("        case %d:\n            return %s;" % (i, code) for i, code in enumerate(self.guards))
+        action_cases = "\n".join("        case %d:\n%s\n            break;" % (i, code) for i, code in enumerate(self.actions))
+        members = member_declarations(self.members, self.translator, "    ")
+        events = ",\n        ".join(quoted(event) for event in self.events) or "nullptr"
+        return HEADER_TEMPLATE.format(
+            class_name=class_name,
+            initial=initial,
+            guards=guard_cases + "\n" if guard_cases else "",
+            actions=action_cases + "\n" if action_cases else "",
+            states=",\n        ".join(state_rows),
+            transitions=",\n        ".join(transition_rows) or "{NONE, NONE, NONE, NONE}",
+            transition_count=len(transition_rows),
+            events=events,
+            event_count=len(self.events),
+            members=members + "\n" if members else "")
+
+
+HEADER_TEMPLATE = """// generated by generate_table_sm.py, do not edit
+
+#pragma once
+
+#include <utility>
+#include <TableStateMachine.h>
+
+class {class_name} : public TableStateMachine
+{{
+public:
+    {class_name}() :
+            TableStateMachine(STATES, sizeof(STATES) / sizeof(STATES[0]),
+                              TRANSITIONS,
+                              EVENTS, {event_count},
+                              {initial})
+    {{
+    }}
+
+protected:
+    bool guard([[maybe_unused]] int id) override
+    {{
+        switch (id)
+        {{
+{guards}        }}
+        return false;
+    }}
+
+    void action([[maybe_unused]] int id) override
+    {{
+        switch (id)
+        {{
+{actions}        }}
+    }}
+
+private:
+    static constexpr State STATES[] = {{
+        {states}
+    }};
+    // {transition_count} rows, grouped by state in document order
+    static constexpr Transition TRANSITIONS[] = {{
+        {transitions}
+    }};
+    static constexpr const char* EVENTS[] = {{
+        {events}
+    }};
+
+{members}}};
+"""
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("scxml")
+    parser.add_argument("output")
+    args = parser.parse_args()
+    try:
+        header = TableGenerator(ET.parse(args.scxml).getroot()).generate()
+    except (Unsupported, KeyError) as error:
+        print("%s: cannot generate a table state machine, %s" % (args.scxml, error), file=sys.stderr)
+        return 1
+    # unchanged headers keep their timestamp, the skill is not rebuilt
+    if os.path.exists(args.output):
+        with open(args.output) as handle:
+            if handle.read() == header:
+                return 0
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, "w") as handle:
+        handle.write(header)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,319 @@
+"""
+Translation of the ECMAScript expressions found in the generated skill state
+machines into typed C++, shared by the code generators of the skills:
+generate_cpp_datamodel.py (Qt QScxmlCppDataModel, QString/QVariant) and
+generate_table_sm.py (Qt-free transition table, std::string/SkillValue).
+
+Only the subset used by the skills is accepted: literals, datamodel members,
+_event.data.<field>, unary/binary operators and the ternary operator.
+Anything else raises Unsupported.
+"""
+
+import re
+
+SCXML_NS = "http://www.w3.org/2005/07/scxml"
+NS = "{" + SCXML_NS + "}"
+
+# value kinds, mapped to C++ types by a Dialect
+BOOL, INT, DOUBLE, STRING, VARIANT = "bool", "int", "double", "string", "variant"
+
+
+class Unsupported(Exception):
+    pass
+
+
+class Dialect:
+    """C++ spelling of the string and variant types of a backend."""
+
+    def __init__(self, string_type, variant_type, string_literal, is_empty, number_to_string, string_to_number):
+        self.types = {BOOL: "bool", INT: "int", DOUBLE: "double", STRING: string_type, VARIANT: variant_type}
+        self.string_literal = string_literal
+        self.is_empty = is_empty
+        self.number_to_string = number_to_string
+        self.string_to_number = string_to_number
+
+    def type(self, kind):
+        return self.types[kind]
+
+
+QT_DIALECT = Dialect("QString", "QVariant",
+                     string_literal='QStringLiteral("%s")',
+                     is_empty="%s.isEmpty()",
+                     number_to_string="QString::number(%s)",
+                     string_to_number={INT: "%s.toInt()", DOUBLE: "%s.toDouble()"})
+
+STD_DIALECT = Dialect("std::string", "SkillValue",
+                      string_literal='std::string("%s")',
+                      is_empty="%s.empty()",
+                      number_to_string="SkillValue(%s).toString()",
+                      string_to_number={INT: "SkillValue(%s).toInt()", DOUBLE: "SkillValue(%s).toDouble()"})
+
+
+# ---------------------------------------------------------------- parsing
+
+TOKEN_RE = re.compile(r"""\s*(?:
+    (?P<number>\d+\.\d*|\.\d+|\d+)|
+    (?P<string>'(?:[^'\\]|\\.)*'|"(?:[^"\\]|\\.)*")|
+    (?P<name>[A-Za-z_]\w*)|
+    (?P<op>===|!==|==|!=|<=|>=|&&|\|\||[!<>+\-*/%?:().])
+)""", re.VERBOSE)
+
+
+def tokenize(expr):
+    tokens = []
+    pos = 0
+    expr = expr.rstrip()
+    while pos < len(expr):
+        match = TOKEN_RE.match(expr, pos)
+        if not match:
+            raise Unsupported("cannot parse '%s'" % expr)
+        pos = match.end()
+        kind = match.lastgroup
+        tokens.append((kind, match.group(kind)))
+    return tokens
+
+
+class Parser:
+    """Precedence climbing over the subset of ECMAScript used by the skills."""
+
+    BINARY = [("||",), ("&&",), ("==", "!=", "===", "!=="), ("<", ">", "<=", ">="), ("+", "-"), ("*", "/", "%")]
+
+    def __init__(self, expr):
+        self.expr = expr
+        self.tokens = tokenize(expr)
+        self.pos = 0
+
+    def peek(self):
+        return self.tokens[self.pos] if self.pos < len(self.tokens) else (None, None)
+
+    def take(self, value=None):
+        token = self.peek()
+        if token[0] is None or (value is not None and token[1] != value):
+            raise Unsupported("unexpected end of '%s'" % self.expr)
+        self.pos += 1
+        return token
+
+    def parse(self):
+        if not self.tokens:
+            raise Unsupported("empty expression")
+        node = self.ternary()
+        if self.pos != len(self.tokens):
+            raise Unsupported("cannot parse '%s'" % self.expr)
+        return node
+
+    def ternary(self):
+        node = self.binary(0)
+        if self.peek() == ("op", "?"):
+            self.take()
+            then = self.ternary()
+            self.take(":")
+            return ("ternary", node, then, self.ternary())
+        return node
+
+    def binary(self, level):
+        if level == len(self.BINARY):
+            return self.unary()
+        node = self.binary(level + 1)
+        while self.peek()[0] == "op" and self.peek()[1] in self.BINARY[level]:
+            op = self.take()[1]
+            node = ("binary", op.replace("===", "==").replace("!==", "!="), node, self.binary(level + 1))
+        return node
+
+    def unary(self):
+        if self.peek() in (("op", "!"), ("op", "-")):
+            op = self.take()[1]
+            return ("unary", op, self.unary())
+        return self.primary()
+
+    def primary(self):
+        kind, value = self.take()
+        if kind == "op" and value == "(":
+            node = self.ternary()
+            self.take(")")
+            return node
+        if kind == "number":
+            return ("literal", DOUBLE if "." in value else INT, value)
+        if kind == "string":
+            text = value[1:-1].replace('\\"', '"').replace("\\'", "'").replace('"', '\\"')
+            return ("literal", STRING, text)
+        if kind == "name":
+            if value in ("true", "false"):
+                return ("literal", BOOL, value)
+            if value == "_event":
+                return self.event()
+            if value in ("typeof", "_msg", "_res", "_req", "_name", "_sessionid", "_ioprocessors", "In"):
+                raise Unsupported("'%s' in '%s'" % (value, self.expr))
+            if self.peek() == ("op", "."):
+                raise Unsupported("member access on '%s' in '%s'" % (value, self.expr))
+            return ("member", value)
+        raise Unsupported("cannot parse '%s'" % self.expr)
+
+    def event(self):
+        # only the fields of the event data are reachable: _event.data.<field>
+        self.take(".")
+        if self.take()[1] != "data" or self.peek() != ("op", "."):
+            raise Unsupported("only _event.data.<field> is supported in '%s'" % self.expr)
+        self.take(".")
+        kind, field = self.take()
+        if kind != "name" or self.peek() == ("op", "."):
+            raise Unsupported("only _event.data.<field> is supported in '%s'" % self.expr)
+        return ("event", field)
+
+
+def parse(expr):
+    return Parser(expr).parse()
+
+
+def common_type(left, right):
+    if left == right:
+        return left
+    if STRING in (left, right):
+        return STRING
+    if VARIANT in (left, right):
+        return right if left == VARIANT else left
+    return DOUBLE if DOUBLE in (left, right) else INT
+
+
+# ---------------------------------------------------------------- translation
+
+class Translator:
+    def __init__(self, members, dialect):
+        """members: name -> value kind of the datamodel members."""
+        self.members = members
+        self.dialect = dialect
+
+    def convert(self, code, source, target):
+        """C++ for the value of 'code' (of kind source) seen as target, with ECMAScript truthiness."""
+        dialect = self.dialect
+        if source == target:
+            return code
+        if target == VARIANT:
+            return "%s(%s)" % (dialect.type(VARIANT), code)
+        if source == VARIANT:
+            return {BOOL: "%s.toBool()", INT: "%s.toInt()", DOUBLE: "%s.toDouble()", STRING: "%s.toString()"}[target] % code
+        if target == BOOL:
+            return "!" + dialect.is_empty % code if source == STRING else "(%s != 0)" % code
+        if target == STRING:
+            if source == BOOL:
+                return "%s(%s).toString()" % (dialect.type(VARIANT), code)
+            return dialect.number_to_string % code
+        if source == STRING:
+            return dialect.string_to_number[target] % code
+        return code
+
+    def emit(self, node):
+        """Returns (C++ code, kind) of an expression tree."""
+        convert = self.convert
+        kind = node[0]
+        if kind == "literal":
+            if node[1] == STRING:
+                return self.dialect.string_literal % node[2], STRING
+            return node[2], node[1]
+        if kind == "member":
+            if node[1] not in self.members:
+                raise Unsupported("undeclared variable '%s'" % node[1])
+            return node[1], self.members[node[1]]
+        if kind == "event":
+            return "eventData(%s)" % (self.dialect.string_literal % node[1]), VARIANT
+        if kind == "unary":
+            code, source = self.emit(node[2])
+            if node[1] == "!":
+                code = convert(code, source, BOOL)
+                if code.startswith("!") and code.count("!") == 1:
+                    return code[1:], BOOL
+                return "!%s" % self.wrap(code), BOOL
+            target = DOUBLE if source in (DOUBLE, VARIANT, STRING) else INT
+            return "-%s" % self.wrap(convert(code, source, target)), target
+        if kind == "ternary":
+            condition_code, condition_type = self.emit(node[1])
+            condition = convert(condition_code, condition_type, BOOL)
+            then_code, then_type = self.emit(node[2])
+            else_code, else_type = self.emit(node[3])
+            target = then_type if then_type == else_type else VARIANT
+            return "(%s ? %s : %s)" % (condition, convert(then_code, then_type, target), convert(else_code, else_type, target)), target
+        op, left, right = node[1], node[2], node[3]
+        left_code, left_type = self.emit(left)
+        right_code, right_type = self.emit(right)
+        if op in ("&&", "||"):
+            return "(%s %s %s)" % (convert(left_code, left_type, BOOL), op, convert(right_code, right_type, BOOL)), BOOL
+        if op in ("==", "!="):
+            target = common_type(left_type, right_type)
+            return "(%s %s %s)" % (convert(left_code, left_type, target), op, convert(right_code, right_type, target)), BOOL
+        if op == "+" and STRING in (left_type, right_type):
+            return "(%s + %s)" % (convert(left_code, left_type, STRING), convert(right_code, right_type, STRING)), STRING
+        target = DOUBLE if DOUBLE in (left_type, right_type) or VARIANT in (left_type, right_type) or STRING in (left_type, right_type) or op == "/" else INT
+        if op == "%":
+            target = INT
+        result = BOOL if op in ("<", ">", "<=", ">=") else target
+        return "(%s %s %s)" % (convert(left_code, left_type, target), op, convert(right_code, right_type, target)), result
+
+    def wrap(self, code):
+        return code if re.fullmatch(r"\w+", code) else "(%s)" % code
+
+    def typed(self, expr, target):
+        code, source = self.emit(parse(expr))
+        return self.convert(code, source, target)
+
+    def value(self, expr):
+        return self.emit(parse(expr))[0]
+
+
+# ---------------------------------------------------------------- datamodel
+
+def literal_type(expr):
+    try:
+        node = parse(expr)
+    except Unsupported:
+        return None
+    if node[0] == "unary" and node[1] == "-" and node[2][0] == "literal":
+        return node[2][1]
+    return node[1] if node[0] == "literal" else None
+
+
+def infer_members(root):
+    """Member name -> (value kind, initial ECMAScript expression or None).
+
+    The kind comes from the literals given to the member, in <data> and in
+    <assign>; members holding values of different kinds, or only values
+    coming from events, are variants."""
+    candidates = {}
+    initial = {}
+    for data in root.iter(NS + "data"):
+        name = data.get("id")
+        if data.get("src") or len(data) or (data.text or "").strip():
+            raise Unsupported("<data id=\"%s\"> with inline content or src" % name)
+        expr = (data.get("expr") or "").strip()
+        initial[name] = expr or None
+        candidates.setdefault(name, set())
+        if expr:
+            kind = literal_type(expr)
+            if kind is None:
+                raise Unsupported("initial value of '%s' is not a literal" % name)
+            candidates[name].add(kind)
+    for assign in root.iter(NS + "assign"):
+        name = assign.get("location")
+        candidates.setdefault(name, set())
+        initial.setdefault(name, None)
+        kind = literal_type(assign.get("expr") or "")
+        if kind:
+            candidates[name].add(kind)
+    members = {}
+    for name, kinds in candidates.items():
+        if not re.fullmatch(r"[A-Za-z_]\w*", name or ""):
+            raise Unsupported("cannot assign to '%s'" % name)
+        if kinds <= {INT, DOUBLE} and DOUBLE in kinds:
+            kinds = {DOUBLE}
+        members[name] = (kinds.pop() if len(kinds) == 1 else VARIANT, initial[name])
+    return members
+
+
+def member_declarations(members, translator, indent):
+    """One C++ member declaration per datamodel member, initialized as in <data>."""
+    lines = []
+    for name, (kind, expr) in sorted(members.items()):
+        cpp_type = translator.dialect.type(kind)
+        if expr is None:
+            lines.append("%s%s %s;" % (indent, cpp_type, name))
+        else:
+            lines.append("%s%s %s{%s};" % (indent, cpp_type, name, translator.typed(expr, kind)))
+    return "\n".join(lines)
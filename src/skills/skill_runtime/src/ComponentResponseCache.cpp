@@ -0,0 +1,107 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file ComponentResponseCache.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <ComponentResponseCache.h>
+
+ComponentResponseCache& ComponentResponseCache::instance()
+{
+    static ComponentResponseCache cache;
+    return cache;
+}
+
+
+ComponentResponseCache::ComponentResponseCache()
+{
+    for (const auto& policy : componentCachePolicies())
+    {
+        auto& function = m_functions[std::string(policy.interfaceName) + "/" + policy.functionName];
+        function.ttl = std::chrono::milliseconds(policy.ttlMs);
+        function.invalidatedBy = policy.invalidatedBy;
+        function.invalidatedByType = policy.invalidatedByType;
+    }
+}
+
+
+bool ComponentResponseCache::isCached(const std::string& interfaceName, const std::string& functionName) const
+{
+    return m_functions.count(interfaceName + "/" + functionName) > 0;
+}
+
+
+std::shared_ptr<const void> ComponentResponseCache::lookup(const std::shared_ptr<rclcpp::Node>& node, const std::string& function, const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& cached = m_functions.at(function);
+    if (!cached.invalidatedBy.empty() && !cached.subscription && node)
+    {
+        cached.subscription = node->create_generic_subscription(cached.invalidatedBy, cached.invalidatedByType, rclcpp::QoS(10),
+            [this, function](std::shared_ptr<const rclcpp::SerializedMessage>)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_functions.at(function).entries.clear();
+            });
+    }
+    auto entry = cached.entries.find(key);
+    if (entry == cached.entries.end())
+    {
+        return nullptr;
+    }
+    if (entry->second.expires < std::chrono::steady_clock::now())
+    {
+        cached.entries.erase(entry);
+        return nullptr;
+    }
+    return entry->second.response;
+}
+
+
+void ComponentResponseCache::store(const std::string& function, const std::string& key, std::shared_ptr<const void> response)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& cached = m_functions.at(function);
+    cached.entries[key] = Entry{std::move(response), std::chrono::steady_clock::now() + cached.ttl};
+}
+
+
+void ComponentResponseCache::invalidate(const std::string& interfaceName, const std::string& functionName)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto cached = m_functions.find(interfaceName + "/" + functionName);
+    if (cached != m_functions.end())
+    {
+        cached->second.entries.clear();
+    }
+}
+
+
+void ComponentResponseCache::invalidateGetters(const std::string& interfaceName, const std::string& calledFunction)
+{
+    if (isCached(interfaceName, calledFunction))
+    {
+        return;
+    }
+    std::string prefix = interfaceName + "/";
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto cached = m_functions.lower_bound(prefix); cached != m_functions.end() && cached->first.compare(0, prefix.size(), prefix) == 0; ++cached)
+    {
+        cached->second.entries.clear();
+    }
+}
+
+
+void ComponentResponseCache::invalidateAll()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& cached : m_functions)
+    {
+        cached.second.entries.clear();
+    }
+}
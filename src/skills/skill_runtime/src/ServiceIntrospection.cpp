@@ -0,0 +1,167 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file ServiceIntrospection.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <ServiceIntrospection.h>
+
+namespace
+{
+constexpr auto SUBSCRIBERS_CHECK_PERIOD = std::chrono::seconds(1);
+constexpr char DEFAULT_PARAMETER[] = "service_introspection";
+constexpr char OVERRIDES_PARAMETER[] = "service_introspection_overrides";
+}
+
+
+ServiceIntrospection::ServiceIntrospection(std::shared_ptr<rclcpp::Node> node) :
+        m_node(std::move(node))
+{
+    if (!m_node->has_parameter(DEFAULT_PARAMETER))
+    {
+        m_node->declare_parameter<std::string>(DEFAULT_PARAMETER, "auto");
+    }
+    if (!m_node->has_parameter(OVERRIDES_PARAMETER))
+    {
+        m_node->declare_parameter<std::vector<std::string>>(OVERRIDES_PARAMETER, std::vector<std::string>());
+    }
+    auto result = onParameters({m_node->get_parameter(DEFAULT_PARAMETER), m_node->get_parameter(OVERRIDES_PARAMETER)});
+    if (!result.successful)
+    {
+        RCLCPP_ERROR(m_node->get_logger(), "%s, service introspection stays auto", result.reason.c_str());
+    }
+    m_parametersCallback = m_node->add_on_set_parameters_callback(
+        [this](const std::vector<rclcpp::Parameter>& parameters) { return onParameters(parameters); });
+}
+
+
+bool ServiceIntrospection::parseLevel(const std::string& text, Level& level)
+{
+    static const std::map<std::string, Mode> modes = {
+        {"off", Mode::OFF}, {"metadata", Mode::METADATA}, {"contents", Mode::CONTENTS}, {"auto", Mode::AUTO}};
+    auto mode = modes.find(text);
+    if (mode != modes.end())
+    {
+        level = Level{mode->second, 1};
+        return true;
+    }
+    const std::string sampled = "sampled:";
+    if (text.compare(0, sampled.size(), sampled) == 0)
+    {
+        try
+        {
+            int every = std::stoi(text.substr(sampled.size()));
+            if (every > 0)
+            {
+                level = Level{Mode::SAMPLED, static_cast<unsigned>(every)};
+                return true;
+            }
+        }
+        catch (const std::exception&)
+        {
+        }
+    }
+    return false;
+}
+
+
+rcl_interfaces::msg::SetParametersResult ServiceIntrospection::onParameters(const std::vector<rclcpp::Parameter>& parameters)
+{
+    rcl_interfaces::msg::SetParametersResult result;
+    result.successful = true;
+    Level defaultLevel;
+    std::map<std::string, Level> overrides;
+    bool changeDefault = false;
+    bool changeOverrides = false;
+    for (const auto& parameter : parameters)
+    {
+        if (parameter.get_name() == DEFAULT_PARAMETER)
+        {
+            changeDefault = true;
+            if (!parseLevel(parameter.as_string(), defaultLevel))
+            {
+                result.successful = false;
+                result.reason = "invalid service introspection level '" + parameter.as_string() + "'";
+            }
+        }
+        else if (parameter.get_name() == OVERRIDES_PARAMETER)
+        {
+            changeOverrides = true;
+            for (const auto& entry : parameter.as_string_array())
+            {
+                auto separator = entry.rfind('=');
+                Level level;
+                if (separator == std::string::npos || !parseLevel(entry.substr(separator + 1), level))
+                {
+                    result.successful = false;
+                    result.reason = "invalid service introspection override '" + entry + "'";
+                    continue;
+                }
+                overrides[entry.substr(0, separator)] = level;
+            }
+        }
+    }
+    if (!result.successful)
+    {
+        return result;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (changeDefault)
+    {
+        m_default = defaultLevel;
+    }
+    if (changeOverrides)
+    {
+        m_overrides = std::move(overrides);
+    }
+    return result;
+}
+
+
+bool ServiceIntrospection::nextState(const std::string& service, rcl_service_introspection_state_t& state)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_overrides.find(service);
+    const Level& level = found != m_overrides.end() ? found->second : m_default;
+    auto& endpoint = m_endpoints[service];
+    switch (level.mode)
+    {
+    case Mode::OFF:
+        state = RCL_SERVICE_INTROSPECTION_OFF;
+        break;
+    case Mode::METADATA:
+        state = RCL_SERVICE_INTROSPECTION_METADATA;
+        break;
+    case Mode::CONTENTS:
+        state = RCL_SERVICE_INTROSPECTION_CONTENTS;
+        break;
+    case Mode::SAMPLED:
+        // the publisher stays up, only the contents are sampled
+        state = endpoint.calls % level.sampleEvery == 0 ? RCL_SERVICE_INTROSPECTION_CONTENTS : RCL_SERVICE_INTROSPECTION_METADATA;
+        break;
+    case Mode::AUTO:
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now - endpoint.subscribersCheckedAt >= SUBSCRIBERS_CHECK_PERIOD)
+        {
+            endpoint.subscribersCheckedAt = now;
+            endpoint.hasSubscribers = m_node->count_subscribers(service + "/_service_event") > 0;
+        }
+        state = endpoint.hasSubscribers ? RCL_SERVICE_INTROSPECTION_CONTENTS : RCL_SERVICE_INTROSPECTION_OFF;
+        break;
+    }
+    }
+    endpoint.calls++;
+    if (endpoint.configured && endpoint.state == state)
+    {
+        return false;
+    }
+    endpoint.configured = true;
+    endpoint.state = state;
+    return true;
+}
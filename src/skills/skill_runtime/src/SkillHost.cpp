@@ -0,0 +1,71 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file SkillHost.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <SkillHost.h>
+
+SkillHost& SkillHost::instance()
+{
+    static SkillHost host;
+    return host;
+}
+
+
+void SkillHost::open(std::shared_ptr<rclcpp::Executor> executor)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_executor = std::move(executor);
+    // the responses of the component clients only complete a future, one thread serves all the skills
+    m_clientExecutor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    m_clientThread = std::thread([executor = m_clientExecutor]() { executor->spin(); });
+}
+
+
+bool SkillHost::add(std::shared_ptr<rclcpp::Node> node, rclcpp::CallbackGroup::SharedPtr clientGroup)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_executor)
+    {
+        return false;
+    }
+    m_executor->add_node(node);
+    if (clientGroup)
+    {
+        m_clientExecutor->add_callback_group(clientGroup, node->get_node_base_interface());
+    }
+    m_nodes.push_back(node);
+    return true;
+}
+
+
+void SkillHost::close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_executor)
+    {
+        return;
+    }
+    m_clientExecutor->cancel();
+    m_clientThread.join();
+    m_clientExecutor.reset();
+    for (const auto& node : m_nodes)
+    {
+        m_executor->remove_node(node);
+    }
+    m_nodes.clear();
+    m_executor.reset();
+}
+
+
+size_t SkillHost::nodeCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nodes.size();
+}
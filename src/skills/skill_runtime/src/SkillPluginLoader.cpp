@@ -0,0 +1,113 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file SkillPluginLoader.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <dlfcn.h>
+#include <QCoreApplication>
+#include <rclcpp/rclcpp.hpp>
+
+#include <SkillPluginLoader.h>
+
+SkillPluginLoader::~SkillPluginLoader()
+{
+    stop();
+}
+
+
+bool SkillPluginLoader::startEventLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_app != nullptr)
+    {
+        return true;
+    }
+    if (QCoreApplication::instance() != nullptr)
+    {
+        // the host already runs Qt, the skills join its event loop
+        m_app = QCoreApplication::instance();
+        return true;
+    }
+    m_ownsApp = true;
+    m_threadQt = std::make_shared<std::thread>([this]() {
+        static char name[] = "skill_plugins";
+        static char* argv[] = {name, nullptr};
+        int argc = 1;
+        QCoreApplication app(argc, argv);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_app = &app;
+        }
+        m_condition.notify_all();
+        app.exec();
+    });
+    m_condition.wait(lock, [this]() { return m_app != nullptr; });
+    return true;
+}
+
+
+bool SkillPluginLoader::load(const std::string& path)
+{
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr)
+    {
+        RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Cannot load skill plugin %s: %s", path.c_str(), dlerror());
+        return false;
+    }
+    auto create = reinterpret_cast<bool (*)()>(dlsym(handle, SKILL_PLUGIN_ENTRY));
+    auto destroy = reinterpret_cast<void (*)()>(dlsym(handle, SKILL_PLUGIN_EXIT));
+    if (create == nullptr || destroy == nullptr)
+    {
+        RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "%s is not a skill plugin: %s", path.c_str(), dlerror());
+        dlclose(handle);
+        return false;
+    }
+    startEventLoop();
+    // the state machine must belong to the thread running the event loop
+    bool ok = false;
+    QMetaObject::invokeMethod(m_app, [&ok, create]() { ok = create(); }, Qt::BlockingQueuedConnection);
+    // kept even when it did not start, its skill is destroyed by stop()
+    m_handles.push_back(handle);
+    m_destroys.push_back(destroy);
+    if (!ok)
+    {
+        RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Skill plugin %s failed to start", path.c_str());
+        return false;
+    }
+    RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "Loaded skill plugin %s", path.c_str());
+    return true;
+}
+
+
+void SkillPluginLoader::stop()
+{
+    if (m_app != nullptr && !m_destroys.empty())
+    {
+        // the state machines belong to the thread running the event loop
+        QMetaObject::invokeMethod(m_app, [this]() {
+            for (auto destroy : m_destroys)
+            {
+                destroy();
+            }
+        }, Qt::BlockingQueuedConnection);
+        m_destroys.clear();
+    }
+    if (!m_ownsApp || !m_threadQt)
+    {
+        return;
+    }
+    QMetaObject::invokeMethod(m_app, []() { QCoreApplication::quit(); }, Qt::QueuedConnection);
+    if (m_threadQt->joinable())
+    {
+        m_threadQt->join();
+    }
+    m_threadQt.reset();
+    m_app = nullptr;
+    m_ownsApp = false;
+}
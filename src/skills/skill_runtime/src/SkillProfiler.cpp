@@ -0,0 +1,159 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file SkillProfiler.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <algorithm>
+
+#include <SkillProfiler.h>
+
+namespace
+{
+void appendQuoted(std::string& out, const std::string& text)
+{
+    out += '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+
+template <typename MapT, typename AppendT>
+void appendObject(std::string& out, const MapT& entries, AppendT appendValue)
+{
+    out += '{';
+    bool first = true;
+    for (const auto& [name, value] : entries)
+    {
+        if (!first)
+        {
+            out += ',';
+        }
+        first = false;
+        appendQuoted(out, name);
+        out += ':';
+        appendValue(out, value);
+    }
+    out += '}';
+}
+}
+
+
+void SkillLatencyHistogram::record(std::chrono::steady_clock::duration latency)
+{
+    auto us = static_cast<uint64_t>(std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::microseconds>(latency).count()));
+    size_t bucket = 0;
+    while (bucket < BUCKETS - 1 && us >= (uint64_t{1} << bucket))
+    {
+        bucket++;
+    }
+    m_buckets[bucket]++;
+    m_count++;
+    m_totalUs += us;
+    m_minUs = std::min(m_minUs, us);
+    m_maxUs = std::max(m_maxUs, us);
+}
+
+
+void SkillLatencyHistogram::appendJson(std::string& out) const
+{
+    out += "{\"count\":" + std::to_string(m_count);
+    out += ",\"total_us\":" + std::to_string(m_totalUs);
+    out += ",\"min_us\":" + std::to_string(m_count == 0 ? 0 : m_minUs);
+    out += ",\"max_us\":" + std::to_string(m_maxUs);
+    out += ",\"buckets\":[";
+    for (size_t i = 0; i < BUCKETS; i++)
+    {
+        out += (i == 0 ? "" : ",") + std::to_string(m_buckets[i]);
+    }
+    out += "]}";
+}
+
+
+SkillProfiler::SkillProfiler(std::shared_ptr<rclcpp::Node> node, const std::string& skillName) :
+        m_skillName(skillName),
+        m_startedAt(std::chrono::steady_clock::now())
+{
+    m_statsService = node->create_service<std_srvs::srv::Trigger>(skillName + "/stats",
+                                                                  std::bind(&SkillProfiler::onStats,
+                                                                            this,
+                                                                            std::placeholders::_1,
+                                                                            std::placeholders::_2));
+}
+
+
+void SkillProfiler::stateChanged(const std::string& state, bool active)
+{
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (active)
+    {
+        m_enteredAt[state] = now;
+        // the state machine notifies the exits of a transition before its entries
+        if (!m_lastExited.empty())
+        {
+            m_transitions[m_lastExited + "->" + state]++;
+            m_lastExited.clear();
+        }
+        return;
+    }
+    auto entered = m_enteredAt.find(state);
+    if (entered != m_enteredAt.end())
+    {
+        m_states[state].record(now - entered->second);
+        m_enteredAt.erase(entered);
+    }
+    m_lastExited = state;
+}
+
+
+void SkillProfiler::recordCall(const std::string& interface, std::chrono::steady_clock::duration latency)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_calls[interface].record(latency);
+}
+
+
+std::string SkillProfiler::toJson() const
+{
+    auto appendHistogram = [](std::string& out, const SkillLatencyHistogram& histogram) { histogram.appendJson(out); };
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto now = std::chrono::steady_clock::now();
+    std::string out = "{\"skill\":";
+    appendQuoted(out, m_skillName);
+    out += ",\"uptime_us\":" + std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(now - m_startedAt).count());
+    out += ",\"buckets\":" + std::to_string(SkillLatencyHistogram::BUCKETS);
+    // the states active now, their dwell is recorded when they are left
+    out += ",\"active\":";
+    appendObject(out, m_enteredAt, [now](std::string& value, std::chrono::steady_clock::time_point entered) {
+        value += std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(now - entered).count());
+    });
+    out += ",\"states\":";
+    appendObject(out, m_states, appendHistogram);
+    out += ",\"transitions\":";
+    appendObject(out, m_transitions, [](std::string& value, uint64_t count) { value += std::to_string(count); });
+    out += ",\"calls\":";
+    appendObject(out, m_calls, appendHistogram);
+    out += '}';
+    return out;
+}
+
+
+void SkillProfiler::onStats([[maybe_unused]] const std::shared_ptr<std_srvs::srv::Trigger::Request> request,
+                            std::shared_ptr<std_srvs::srv::Trigger::Response> response)
+{
+    response->success = true;
+    response->message = toJson();
+}
@@ -0,0 +1,186 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file SkillTickRegistry.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <algorithm>
+
+#include <SkillTickRegistry.h>
+
+SkillTickRegistry& SkillTickRegistry::instance()
+{
+    static SkillTickRegistry registry;
+    return registry;
+}
+
+
+SkillTickRegistry::~SkillTickRegistry()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopping = true;
+    }
+    m_queueCondition.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+
+void SkillTickRegistry::startWorkers()
+{
+    // with m_mutex held, by the first serveBatch() only
+    if (!m_workers.empty())
+    {
+        return;
+    }
+    // a tick mostly waits for the state machine of its skill, not for the cpu
+    unsigned workers = std::max(4u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < workers; ++i)
+    {
+        m_workers.emplace_back(&SkillTickRegistry::work, this);
+    }
+}
+
+
+void SkillTickRegistry::work()
+{
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    while (true)
+    {
+        m_queueCondition.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+        // the queued ticks still run after a stop request, every batch gets its statuses
+        if (m_queue.empty())
+        {
+            return;
+        }
+        auto tick = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+        tick();
+        lock.lock();
+    }
+}
+
+
+void SkillTickRegistry::registerSkill(const std::string& name, TickFunction tick)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_skills[name] = std::move(tick);
+}
+
+
+void SkillTickRegistry::registerHalt(const std::string& name, HaltFunction halt)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_halts[name] = std::move(halt);
+}
+
+
+void SkillTickRegistry::unregisterSkill(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_skills.erase(name);
+    m_halts.erase(name);
+}
+
+
+bool SkillTickRegistry::contains(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_skills.count(name) > 0;
+}
+
+
+bool SkillTickRegistry::tick(const std::string& name, int8_t& status)
+{
+    TickFunction tick;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_skills.find(name);
+        if (it == m_skills.end())
+        {
+            return false;
+        }
+        tick = it->second;
+    }
+    // the registry is not locked while the skill runs, other skills can be ticked meanwhile
+    status = tick();
+    return true;
+}
+
+
+bool SkillTickRegistry::halt(const std::string& name)
+{
+    HaltFunction halt;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_halts.find(name);
+        if (it == m_halts.end())
+        {
+            return false;
+        }
+        halt = it->second;
+    }
+    halt();
+    return true;
+}
+
+
+bool SkillTickRegistry::serveBatch(std::shared_ptr<rclcpp::Node> node, const std::string& host)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // every skill of the host asks for the service, only the first one creates it
+    if (m_batchServices.count(host) > 0)
+    {
+        return false;
+    }
+    m_batchServices[host] = node->create_service<bt_interfaces_dummy::srv::TickBatch>(host + "/TickBatch",
+                                                                                       std::bind(&SkillTickRegistry::tickBatch,
+                                                                                       this,
+                                                                                       std::placeholders::_1,
+                                                                                       std::placeholders::_2));
+    startWorkers();
+    RCLCPP_INFO(node->get_logger(), "SkillTickRegistry serving %s/TickBatch", host.c_str());
+    return true;
+}
+
+
+void SkillTickRegistry::tickBatch(const std::shared_ptr<bt_interfaces_dummy::srv::TickBatch::Request> request,
+                                  std::shared_ptr<bt_interfaces_dummy::srv::TickBatch::Response> response)
+{
+    std::vector<std::future<int8_t>> ticks;
+    std::vector<bool> found;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::lock_guard<std::mutex> queueLock(m_queueMutex);
+        for (const std::string& name : request->skills)
+        {
+            auto it = m_skills.find(name);
+            found.push_back(it != m_skills.end());
+            if (it != m_skills.end())
+            {
+                m_queue.emplace_back(it->second);
+                ticks.push_back(m_queue.back().get_future());
+            }
+            else
+            {
+                ticks.emplace_back();
+            }
+        }
+    }
+    m_queueCondition.notify_all();
+    // the statuses of unknown skills stay invalid, the leaf then ticks them directly
+    for (size_t i = 0; i < ticks.size(); ++i)
+    {
+        response->statuses.push_back(found[i] ? ticks[i].get() : 0);
+        response->is_ok.push_back(found[i]);
+    }
+}
@@ -0,0 +1,423 @@
+/******************************************************************************
+ *                                                                            *
+ * Copyright (C) 2023 Fondazione Istituto Italiano di Tecnologia (IIT)        *
+ * All Rights Reserved.                                                       *
+ *                                                                            *
+ ******************************************************************************/
+/**
+ * @file TableStateMachine.cpp
+ * @authors: Stefano Bernagozzi <stefano.bernagozzi@iit.it>
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <TableStateMachine.h>
+
+namespace
+{
+// eventless transitions looping forever would never give the thread back
+constexpr int MAX_MICROSTEPS = 1000;
+}
+
+
+bool SkillValue::isNull() const
+{
+    return std::holds_alternative<std::monostate>(m_value);
+}
+
+
+bool SkillValue::toBool() const
+{
+    if (auto value = std::get_if<bool>(&m_value))
+    {
+        return *value;
+    }
+    if (auto value = std::get_if<int64_t>(&m_value))
+    {
+        return *value != 0;
+    }
+    if (auto value = std::get_if<double>(&m_value))
+    {
+        return *value != 0.0;
+    }
+    if (auto value = std::get_if<std::string>(&m_value))
+    {
+        return !value->empty() && *value != "0" && *value != "false";
+    }
+    return false;
+}
+
+
+int SkillValue::toInt() const
+{
+    if (auto value = std::get_if<std::string>(&m_value))
+    {
+        return static_cast<int>(std::strtol(value->c_str(), nullptr, 10));
+    }
+    return static_cast<int>(toDouble());
+}
+
+
+double SkillValue::toDouble() const
+{
+    if (auto value = std::get_if<bool>(&m_value))
+    {
+        return *value ? 1.0 : 0.0;
+    }
+    if (auto value = std::get_if<int64_t>(&m_value))
+    {
+        return static_cast<double>(*value);
+    }
+    if (auto value = std::get_if<double>(&m_value))
+    {
+        return *value;
+    }
+    if (auto value = std::get_if<std::string>(&m_value))
+    {
+        return std::strtod(value->c_str(), nullptr);
+    }
+    return 0.0;
+}
+
+
+std::string SkillValue::toString() const
+{
+    if (auto value = std::get_if<bool>(&m_value))
+    {
+        return *value ? "true" : "false";
+    }
+    if (auto value = std::get_if<int64_t>(&m_value))
+    {
+        return std::to_string(*value);
+    }
+    if (auto value = std::get_if<double>(&m_value))
+    {
+        std::ostringstream stream;
+        stream << *value;
+        return stream.str();
+    }
+    if (auto value = std::get_if<std::string>(&m_value))
+    {
+        return *value;
+    }
+    return std::string();
+}
+
+
+bool SkillValue::operator==(const SkillValue& other) const
+{
+    if (m_value.index() == other.m_value.index())
+    {
+        return m_value == other.m_value;
+    }
+    // like QVariant: numbers compare by value, anything else through its string
+    bool numeric = !std::holds_alternative<std::string>(m_value) && !std::holds_alternative<std::monostate>(m_value);
+    bool otherNumeric = !std::holds_alternative<std::string>(other.m_value) && !std::holds_alternative<std::monostate>(other.m_value);
+    if (numeric && otherNumeric)
+    {
+        return toDouble() == other.toDouble();
+    }
+    return toString() == other.toString();
+}
+
+
+void SkillEventData::insert(const std::string& field, SkillValue value)
+{
+    for (auto& entry : m_fields)
+    {
+        if (entry.first == field)
+        {
+            entry.second = std::move(value);
+            return;
+        }
+    }
+    m_fields.emplace_back(field, std::move(value));
+}
+
+
+SkillValue SkillEventData::value(std::string_view field) const
+{
+    for (const auto& entry : m_fields)
+    {
+        if (entry.first == field)
+        {
+            return entry.second;
+        }
+    }
+    return SkillValue();
+}
+
+
+TableStateMachine::TableStateMachine(const State* states, size_t stateCount,
+                                     const Transition* transitions,
+                                     const char* const* events, size_t eventCount,
+                                     int16_t initialState) :
+        m_states(states),
+        m_stateCount(stateCount),
+        m_transitions(transitions),
+        m_events(events),
+        m_eventCount(eventCount),
+        m_initialState(initialState),
+        m_stateListeners(stateCount)
+{
+}
+
+
+bool TableStateMachine::start()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_running || m_initialState < 0 || static_cast<size_t>(m_initialState) >= m_stateCount)
+    {
+        return false;
+    }
+    m_running = true;
+    m_processing = true;
+    lock.unlock();
+    // the initial state is entered like the target of a transition, without an event
+    SkillEvent none;
+    m_currentEvent = &none;
+    enterState(m_initialState);
+    macrostep(none);
+    lock.lock();
+    processQueue(lock);
+    return true;
+}
+
+
+bool TableStateMachine::isRunning() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_running;
+}
+
+
+void TableStateMachine::submitEvent(const std::string& name, SkillEventData data)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_externalQueue.emplace_back(name, std::move(data));
+    if (m_processing || !m_running)
+    {
+        // the thread already processing the queue (maybe this one, from a
+        // listener) will get to it, events before start() wait for it
+        return;
+    }
+    m_processing = true;
+    processQueue(lock);
+}
+
+
+void TableStateMachine::connectToEvent(const std::string& name, Listener listener)
+{
+    std::lock_guard<std::mutex> lock(m_listenersMutex);
+    m_listeners[name].push_back(std::move(listener));
+}
+
+
+std::string TableStateMachine::activeStateName() const
+{
+    auto state = m_activeState.load();
+    return state == NONE ? std::string() : std::string(m_states[state].name);
+}
+
+
+void TableStateMachine::log(const std::string& label, const std::string& message)
+{
+    std::clog << label << ": " << message << std::endl;
+}
+
+
+void TableStateMachine::send(const std::string& name, SkillEventData data)
+{
+    m_outgoing.emplace_back(name, std::move(data));
+}
+
+
+void TableStateMachine::raise(const std::string& name, SkillEventData data)
+{
+    m_internalQueue.emplace_back(name, std::move(data));
+}
+
+
+SkillValue TableStateMachine::eventData(const std::string& field) const
+{
+    return m_currentEvent ? m_currentEvent->data().value(field) : SkillValue();
+}
+
+
+std::vector<std::string> TableStateMachine::stateNames() const
+{
+    std::vector<std::string> names;
+    names.reserve(m_stateCount);
+    for (size_t i = 0; i < m_stateCount; i++)
+    {
+        names.emplace_back(m_states[i].name);
+    }
+    return names;
+}
+
+
+bool TableStateMachine::connectToState(const std::string& name, StateListener listener)
+{
+    for (size_t i = 0; i < m_stateCount; i++)
+    {
+        if (name == m_states[i].name)
+        {
+            m_stateListeners[i].push_back(std::move(listener));
+            return true;
+        }
+    }
+    return false;
+}
+
+
+int16_t TableStateMachine::eventIndex(const std::string& name) const
+{
+    for (size_t i = 0; i < m_eventCount; i++)
+    {
+        if (std::strcmp(m_events[i], name.c_str()) == 0)
+        {
+            return static_cast<int16_t>(i);
+        }
+    }
+    return NONE;
+}
+
+
+void TableStateMachine::processQueue(std::unique_lock<std::mutex>& lock)
+{
+    // called with the lock held and m_processing set by this thread
+    while (true)
+    {
+        std::vector<SkillEvent> outgoing;
+        outgoing.swap(m_outgoing);
+        if (!outgoing.empty())
+        {
+            lock.unlock();
+            std::vector<Listener> listeners;
+            for (const auto& event : outgoing)
+            {
+                {
+                    std::lock_guard<std::mutex> listenersLock(m_listenersMutex);
+                    auto it = m_listeners.find(event.name());
+                    listeners = it == m_listeners.end() ? std::vector<Listener>() : it->second;
+                }
+                for (const auto& listener : listeners)
+                {
+                    listener(event);
+                }
+            }
+            lock.lock();
+            // sent events also reach the external queue of the machine itself
+            for (auto& event : outgoing)
+            {
+                m_externalQueue.push_back(std::move(event));
+            }
+        }
+        if (m_externalQueue.empty())
+        {
+            m_processing = false;
+            return;
+        }
+        SkillEvent event = std::move(m_externalQueue.front());
+        m_externalQueue.pop_front();
+        lock.unlock();
+        macrostep(event);
+        lock.lock();
+    }
+}
+
+
+void TableStateMachine::macrostep(const SkillEvent& event)
+{
+    m_currentEvent = &event;
+    if (!event.name().empty())
+    {
+        int16_t index = eventIndex(event.name());
+        if (index == NONE || !takeTransition(index))
+        {
+            m_currentEvent = nullptr;
+            return;
+        }
+    }
+    // eventless transitions and raised events complete the step
+    for (int microsteps = 0; microsteps < MAX_MICROSTEPS; microsteps++)
+    {
+        if (takeTransition(NONE))
+        {
+            continue;
+        }
+        if (m_internalQueue.empty())
+        {
+            m_currentEvent = nullptr;
+            return;
+        }
+        SkillEvent internal = std::move(m_internalQueue.front());
+        m_internalQueue.pop_front();
+        m_currentEvent = &internal;
+        int16_t index = eventIndex(internal.name());
+        if (index != NONE)
+        {
+            takeTransition(index);
+        }
+        m_currentEvent = &event;
+    }
+    std::cerr << "TableStateMachine: too many eventless transitions in state " << activeStateName() << std::endl;
+    m_internalQueue.clear();
+    m_currentEvent = nullptr;
+}
+
+
+bool TableStateMachine::takeTransition(int16_t event)
+{
+    int16_t source = m_activeState.load();
+    const State& state = m_states[source];
+    for (int16_t i = state.firstTransition; i < state.firstTransition + state.transitionCount; i++)
+    {
+        const Transition& transition = m_transitions[i];
+        if (transition.event != event || (transition.guard != NONE && !guard(transition.guard)))
+        {
+            continue;
+        }
+        if (transition.target != NONE)
+        {
+            if (state.onExit != NONE)
+            {
+                action(state.onExit);
+            }
+            notifyState(source, false);
+        }
+        if (transition.action != NONE)
+        {
+            action(transition.action);
+        }
+        if (transition.target != NONE)
+        {
+            enterState(transition.target);
+        }
+        return true;
+    }
+    return false;
+}
+
+
+void TableStateMachine::enterState(int16_t state)
+{
+    m_activeState.store(state);
+    notifyState(state, true);
+    if (m_states[state].onEntry != NONE)
+    {
+        action(m_states[state].onEntry);
+    }
+}
+
+
+void TableStateMachine::notifyState(int16_t state, bool active)
+{
+    for (const auto& listener : m_stateListeners[state])
+    {
+        listener(active);
+    }
+}
@@ -1,10 +1,22 @@
 # pragma once
 
+#include <condition_variable>
 #include <mutex>
+#include <optional>
 #include <thread>
 #include <rclcpp/rclcpp.hpp>
 #include "rclcpp_action/rclcpp_action.hpp"
 #include "$className$SM.h"
+#ifdef SKILL_TABLE_SM
+#include <TableStateMachine.h>
+#else
+#include <QScxmlEvent>
+#include <QVariantMap>
+// events and event data as the callbacks see them, with either state machine backend
+using SkillEvent = QScxmlEvent;
+using SkillEventData = QVariantMap;
+using SkillValue = QVariant;
+#endif
 #include <bt_interfaces_dummy/msg/$skillTypeLC$_response.hpp>/*INTERFACES_LIST*/
 /*INTERFACE*/
 #include <$eventData.interfaceName$/srv/$eventData.functionNameSnakeCase$.hpp> /*END_INTERFACE*/
@@ -12,7 +24,13 @@
 #include <$eventData.interfaceName$/action/$eventData.functionNameSnakeCase$.hpp> /*END_ACTION_INTERFACE*/
 /*TOPIC_INTERFACE*/
 #include <$eventData.interfaceData[interfaceDataType]$.hpp> /*END_TOPIC_INTERFACE*/
-/*TICK*/#include <bt_interfaces_dummy/srv/tick_$skillTypeLC$.hpp>/*END_TICK*/
+/*TICK*/#include <bt_interfaces_dummy/srv/tick_$skillTypeLC$.hpp>
+#include <SkillTickRegistry.h>
+#include <SkillHost.h>
+#include <AsyncComponentCall.h>
+#include <ComponentResponseCache.h>
+#include <ServiceIntrospection.h>
+#include <SkillProfiler.h>/*END_TICK*/
 /*HALT*/#include <bt_interfaces_dummy/srv/halt_$skillTypeLC$.hpp>/*END_HALT*/
 /*DATAMODEL*/
 #include "$skillName$SkillDataModel.h" /*END_DATAMODEL*/
@@ -33,8 +51,9 @@ class $className$
 {
 public:
 	$className$(std::string name );
+	~$className$();
 	bool start(int argc, char * argv[]);
-	static void spin(std::shared_ptr<rclcpp::Node> node);
+	void spin();
 	/*TICK_CMD*/
 	void tick( [[maybe_unused]] const std::shared_ptr<bt_interfaces_dummy::srv::Tick$skillType$::Request> request,
 			   std::shared_ptr<bt_interfaces_dummy::srv::Tick$skillType$::Response>      response);/*END_TICK_CMD*/
@@ -46,15 +65,30 @@ public:
 
 private:
 	std::shared_ptr<std::thread> m_threadSpin;
+	// standalone only, spun by m_threadSpin: skill_host spins the node itself
+	std::shared_ptr<rclcpp::executors::MultiThreadedExecutor> m_executor;
 	std::shared_ptr<rclcpp::Node> m_node;
+	rclcpp::CallbackGroup::SharedPtr m_clientCallbackGroup;
+	std::shared_ptr<ServiceIntrospection> m_introspection;
+	// only with SKILL_PROFILING
+	std::shared_ptr<SkillProfiler> m_profiler;
 	std::mutex m_requestMutex;
 	std::string m_name;
+	/*DATAMODEL*/// before the state machine, which keeps a pointer to it
+	$skillName$SkillDataModel m_dataModel; /*END_DATAMODEL*/
 	$SMName$ m_stateMachine;
+	// TICK_RESPONSE and HALT_RESPONSE wake up the request waiting for them
+	std::mutex m_responseMutex;
+	std::condition_variable m_responseCondition;
 	/*TICK_RESPONSE*/std::atomic<Status> m_tickResult{Status::undefined};/*END_TICK_RESPONSE*/
-	/*TICK_CMD*/rclcpp::Service<bt_interfaces_dummy::srv::Tick$skillType$>::SharedPtr m_tickService;/*END_TICK_CMD*/
+	/*TICK_CMD*/rclcpp::Service<bt_interfaces_dummy::srv::Tick$skillType$>::SharedPtr m_tickService;
+	rclcpp::Publisher<bt_interfaces_dummy::msg::$skillType$Response>::SharedPtr m_statusPublisher;
+	rclcpp::TimerBase::SharedPtr m_statusTimer;
+	std::optional<int8_t> m_lastPublishedStatus;
+	int8_t tickStateMachine(bool publishAlways = false);
+	void publishStatus(int8_t status, bool publishAlways);/*END_TICK_CMD*/
 	/*HALT_RESPONSE*/std::atomic<bool> m_haltResult{false};/*END_HALT_RESPONSE*/
 	/*HALT_CMD*/rclcpp::Service<bt_interfaces_dummy::srv::HaltAction>::SharedPtr m_haltService;/*END_HALT_CMD*/
-	/*DATAMODEL*/$skillName$SkillDataModel m_dataModel; /*END_DATAMODEL*/
 	/*TOPIC_SUBSCRIPTIONS_LIST_H*/
 	/*TOPIC_SUBSCRIPTION_H*/
 	rclcpp::Subscription<$eventData.interfaceData[interfaceDataType]$>::SharedPtr m_subscription_$eventData.functionName$;/*END_TOPIC_SUBSCRIPTION_H*/
@@ -64,6 +98,7 @@ private:
 	std::mutex m_feedbackMutex;
 	rclcpp_action::Client<$eventData.interfaceName$::action::$eventData.functionName$>::SendGoalOptions m_send_goal_options;
 	rclcpp_action::Client<$eventData.interfaceName$::action::$eventData.functionName$>::SharedPtr m_actionClient;
+	std::chrono::steady_clock::time_point m_goalSentAt;
 	void goal_response_callback(const  rclcpp_action::ClientGoalHandle<$eventData.interfaceName$::action::$eventData.functionName$>::SharedPtr & goal_handle);
 	void send_goal($eventData.interfaceName$::action::$eventData.functionName$::Goal);
 	void feedback_callback(
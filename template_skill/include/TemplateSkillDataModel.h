@@ -1,11 +1,12 @@
 # pragma once
 
 #include <QScxmlCppDataModel>
+#include <QScxmlEvent>
+#include <QString>
 #include <QVariant>
-#include <string>
-#include <thread>
-#include <rclcpp/rclcpp.hpp>
 
+// typed members and compiled expressions of $className$SM.scxml, the
+// members are filled by generate_cpp_datamodel.py from its <data> elements
 class $className$DataModel: public QScxmlCppDataModel
 {
     Q_SCXML_DATAMODEL
@@ -13,16 +14,11 @@ class $className$DataModel: public QScxmlCppDataModel
 public:
    $className$DataModel() = default;
    bool setup(const QVariantMap& initialDataValues) override;
-   void log(std::string to_log);
-   //void topic_callback(const ::SharedPtr msg);
-   static void spin(std::shared_ptr<rclcpp::Node> node);
 
 private:
-   //uint m_status;
-   //rclcpp::Subscription<>::SharedPtr m_subscription;
-   std::shared_ptr<std::thread> m_threadSpin;
-   std::shared_ptr<rclcpp::Node> m_node;
-	
+   QVariant eventData(const QString& field) const;
+
+/*DATA_MEMBERS*/
 };
 
-Q_DECLARE_METATYPE(::$className$DataModel*)
\ No newline at end of file
+Q_DECLARE_METATYPE(::$className$DataModel*)
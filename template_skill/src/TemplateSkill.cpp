@@ -1,49 +1,119 @@
 #include "$className$.h"
 #include <future>
+#include <iostream>
+#ifndef SKILL_TABLE_SM
 #include <QTimer>
 #include <QDebug>
 #include <QTime>
-#include <iostream>
 #include <QStateMachine>
+#endif
 
 #include <type_traits>
 
+// event fields are read and written with the type of the interface field:
+// no string round-trip, and a field without an event representation is a
+// compile error instead of an exception at the first call
 template<typename T>
-T convert(const std::string& str) {
-    if constexpr (std::is_same_v<T, int>) {
-        return std::stoi(str);
-    } else if constexpr (std::is_same_v<T, double>) {
-        return std::stod(str);
-    } else if constexpr (std::is_same_v<T, float>) {
-        return std::stof(str);
-    } 
-    else if constexpr (std::is_same_v<T, bool>) { 
-        if (str == "true" || str == "1") { 
-            return true; 
-        } else if (str == "false" || str == "0") { 
-            return false; 
-        } else { 
-            throw std::invalid_argument("Invalid boolean value"); 
-        } 
-    } 
-    else if constexpr (std::is_same_v<T, std::string>) {
-        return str;
+constexpr bool isEventType = std::is_arithmetic_v<T> || std::is_same_v<T, std::string>;
+
+template<typename T>
+[[maybe_unused]] static T eventValue(const SkillEvent& event, const char* field)
+{
+    static_assert(isEventType<T>, "the interface field cannot be read from an event");
+#ifdef SKILL_TABLE_SM
+    const SkillValue value = event.data().value(field);
+    if constexpr (std::is_same_v<T, std::string>) {
+        return value.toString();
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return value.toBool();
+    } else if constexpr (std::is_integral_v<T>) {
+        return static_cast<T>(value.toInt());
+    } else {
+        return static_cast<T>(value.toDouble());
     }
-    else {
-        throw std::invalid_argument("Unsupported type conversion");
+#else
+    const SkillValue value = event.data().toMap().value(QLatin1StringView(field));
+    if constexpr (std::is_same_v<T, std::string>) {
+        return value.toString().toStdString();
+    } else {
+        return value.value<T>();
     }
+#endif
 }
 
+template<typename T>
+[[maybe_unused]] static SkillValue toEventValue(const T& value)
+{
+    static_assert(isEventType<T>, "the interface field cannot be written to an event");
+#ifdef SKILL_TABLE_SM
+    return SkillValue(value);
+#else
+    // the types the ECMAScript datamodel and the C++ datamodel expect
+    if constexpr (std::is_same_v<T, std::string>) {
+        return QString::fromStdString(value);
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return QVariant(value);
+    } else if constexpr (std::is_integral_v<T> && sizeof(T) < sizeof(qlonglong)) {
+        return QVariant(static_cast<int>(value));
+    } else if constexpr (std::is_integral_v<T>) {
+        return QVariant(static_cast<qlonglong>(value));
+    } else {
+        return QVariant(static_cast<double>(value));
+    }
+#endif
+}
+
+[[maybe_unused]] static SkillValue toEventValue(const char* value)
+{
+#ifdef SKILL_TABLE_SM
+    return SkillValue(value);
+#else
+    return QString::fromUtf8(value);
+#endif
+}
+
+[[maybe_unused]] static std::string stateName(const std::string& name)
+{
+    return name;
+}
+
+#ifndef SKILL_TABLE_SM
+[[maybe_unused]] static std::string stateName(const QString& name)
+{
+    return name.toStdString();
+}
+#endif
+
 $className$::$className$(std::string name ) :
 		m_name(std::move(name))
 {
     /*DATAMODEL*/m_stateMachine.setDataModel(&m_dataModel);/*END_DATAMODEL*/
 }
 
-void $className$::spin(std::shared_ptr<rclcpp::Node> node)
+$className$::~$className$()
 {
-	rclcpp::spin(node);
-	rclcpp::shutdown();
+	/*TICK*/// the registry must not call into a skill that is gone
+	SkillTickRegistry::instance().unregisterSkill(m_name);/*END_TICK*/
+	// the ROS context usually stopped the executors already, a skill destroyed
+	// before it (a plugin unloaded by its host) stops them here
+	if (m_executor) {
+		m_executor->cancel();
+	}
+	if (m_threadSpin && m_threadSpin->joinable()) {
+		m_threadSpin->join();
+	}
+}
+
+void $className$::spin()
+{
+	// the component clients have a thread of their own, their responses are
+	// delivered even when both threads of the node wait inside a tick or a halt
+	rclcpp::executors::SingleThreadedExecutor clientExecutor;
+	clientExecutor.add_callback_group(m_clientCallbackGroup, m_node->get_node_base_interface());
+	std::thread clientThread([&clientExecutor]() { clientExecutor.spin(); });
+	m_executor->spin();
+	clientExecutor.cancel();
+	clientThread.join();
 }
 
 bool $className$::start(int argc, char*argv[])
@@ -54,6 +124,21 @@ bool $className$::start(int argc, char*argv[])
 	}
 
 	m_node = rclcpp::Node::make_shared(m_name + "Skill");
+	// the component clients have their own group, spun by an executor of its
+	// own: a handler waiting for a response inside a tick callback does not
+	// block its delivery, however many ticks are in flight
+	m_clientCallbackGroup = m_node->create_callback_group(rclcpp::CallbackGroupType::Reentrant, false);
+	// _service_event of the component clients, see the service_introspection parameters
+	m_introspection = std::make_shared<ServiceIntrospection>(m_node);
+#ifdef SKILL_PROFILING
+	// state dwell, transitions and component latencies, served on <name>Skill/stats
+	m_profiler = std::make_shared<SkillProfiler>(m_node, m_name + "Skill");
+	for (const auto& state : m_stateMachine.stateNames()) {
+		m_stateMachine.connectToState(state, [this, name = stateName(state)](bool active) {
+			m_profiler->stateChanged(name, active);
+		});
+	}
+#endif
 	RCLCPP_DEBUG_STREAM(m_node->get_logger(), "$className$::start");
 	std::cout << "$className$::start";
 
@@ -62,13 +147,41 @@ bool $className$::start(int argc, char*argv[])
                                                                            	std::bind(&$className$::tick,
                                                                            	this,
                                                                            	std::placeholders::_1,
-                                                                           	std::placeholders::_2));/*END_TICK*/
+                                                                           	std::placeholders::_2));
+	m_statusPublisher = m_node->create_publisher<bt_interfaces_dummy::msg::$skillType$Response>(m_name + "Skill/status",
+	                                                                                     rclcpp::QoS(1).transient_local());
+	// a condition can re-evaluate itself periodically, the leaves reading the
+	// status topic then get the new value without sending any tick; every
+	// periodic evaluation is published, so that an unchanged status stays fresh
+	int statusPeriod = m_node->declare_parameter<int>("status_period_ms", 0);
+	if (std::string("$skillType$") == "Condition" && statusPeriod > 0) {
+		m_statusTimer = m_node->create_wall_timer(std::chrono::milliseconds(statusPeriod), [this]() {
+			std::unique_lock<std::mutex> lock(m_requestMutex, std::try_to_lock);
+			if (lock.owns_lock()) {
+				tickStateMachine(true);
+			}
+		});
+	}
+	// skills sharing a tick_batch_host are ticked together by <host>/TickBatch
+	SkillTickRegistry::instance().registerSkill(m_name, [this]() {
+		std::lock_guard<std::mutex> lock(m_requestMutex);
+		return tickStateMachine();
+	});
+	std::string batchHost = m_node->declare_parameter<std::string>("tick_batch_host", "");
+	if (!batchHost.empty()) {
+		SkillTickRegistry::instance().serveBatch(m_node, batchHost);
+	}/*END_TICK*/
   /*HALT*/
 	m_haltService = m_node->create_service<bt_interfaces_dummy::srv::Halt$skillType$>(m_name + "Skill/halt",
                                                                             	std::bind(&$className$::halt,
                                                                             	this,
                                                                             	std::placeholders::_1,
-                                                                            	std::placeholders::_2));/*END_HALT*/
+                                                                            	std::placeholders::_2));
+	SkillTickRegistry::instance().registerHalt(m_name, [this]() {
+		auto request = std::make_shared<bt_interfaces_dummy::srv::Halt$skillType$::Request>();
+		auto response = std::make_shared<bt_interfaces_dummy::srv::Halt$skillType$::Response>();
+		halt(request, response);
+	});/*END_HALT*/
   /*ACTION_LIST_C*//*ACTION_C*/
   m_actionClient = rclcpp_action::create_client<$eventData.interfaceName$::action::$eventData.functionName$>(m_node, "/$eventData.componentName$/$eventData.functionName$");
   m_send_goal_options.goal_response_callback = std::bind(&$className$::goal_response_callback, this, std::placeholders::_1);
@@ -80,106 +193,104 @@ bool $className$::start(int argc, char*argv[])
   "/$eventData.functionName$", 10, std::bind(&$className$::topic_callback_$eventData.functionName$, this, std::placeholders::_1));
   /*END_TOPIC_SUBSCRIPTION*/
   /*SEND_EVENT_LIST*//*SEND_EVENT_SRV*/
-  m_stateMachine.connectToEvent("$eventData.event$", [this]([[maybe_unused]]const QScxmlEvent & event){
-      std::shared_ptr<rclcpp::Node> $eventData.nodeName$ = rclcpp::Node::make_shared(m_name + "SkillNode$eventData.functionName$");
-      std::shared_ptr<rclcpp::Client<$eventData.interfaceName$::srv::$eventData.functionName$>> $eventData.clientName$ = $eventData.nodeName$->create_client<$eventData.interfaceName$::srv::$eventData.functionName$>($eventData.serverName$);
+  {
+  // created once, discovery runs in the background and the responses are
+  // delivered by the executor of m_clientCallbackGroup
+  std::shared_ptr<rclcpp::Client<$eventData.interfaceName$::srv::$eventData.functionName$>> $eventData.clientName$ = m_node->create_client<$eventData.interfaceName$::srv::$eventData.functionName$>($eventData.serverName$, rclcpp::ServicesQoS(), m_clientCallbackGroup);
+  m_stateMachine.connectToEvent("$eventData.event$", [this, $eventData.clientName$]([[maybe_unused]]const SkillEvent & event){
       auto request = std::make_shared<$eventData.interfaceName$::srv::$eventData.functionName$::Request>();
-      auto eventParams = event.data().toMap();
       /*PARAM_LIST*//*PARAM*/
-      request->$IT->FIRST$ = convert<decltype(request->$IT->FIRST$)>(eventParams["$IT->FIRST$"].toString().toStdString());/*END_PARAM*/
-      bool wait_succeded{true};
-      int retries = 0;
-      while (!$eventData.clientName$->wait_for_service(std::chrono::seconds(1))) {
-          if (!rclcpp::ok()) {
-              RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Interrupted while waiting for the service '$eventData.functionName$'. Exiting.");
-              wait_succeded = false;
-              break;
-          } 
-          retries++;
-          if(retries == SERVICE_TIMEOUT) {
-              RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Timed out while waiting for the service '$eventData.functionName$'.");
-              wait_succeded = false;
-              break;
+      request->$IT->FIRST$ = eventValue<decltype(request->$IT->FIRST$)>(event, "$IT->FIRST$");/*END_PARAM*/
+      auto callStart = std::chrono::steady_clock::now();
+      // submits the Return event, right away for a cached response, otherwise
+      // from the thread of the client executor: the state machine thread never waits
+      auto returned = [this, callStart](std::shared_ptr<const $eventData.interfaceName$::srv::$eventData.functionName$::Response> response) {
+          if (m_profiler) {
+              m_profiler->recordCall("$eventData.componentName$.$eventData.functionName$", std::chrono::steady_clock::now() - callStart);
           }
-      }
-      if (wait_succeded) {                                                                   
-          auto result = $eventData.clientName$->async_send_request(request);
-          const std::chrono::seconds timeout_duration(SERVICE_TIMEOUT);
-          auto futureResult = rclcpp::spin_until_future_complete($eventData.nodeName$, result, timeout_duration);
-          if (futureResult == rclcpp::FutureReturnCode::SUCCESS) 
-          {
-              auto response = result.get();
-              if( response->is_ok == true) {
-                  QVariantMap data;
-                  data.insert("is_ok", true);/*RETURN_PARAM_LIST*//*RETURN_PARAM*/
-                  data.insert("$eventData.interfaceDataField$", response->$eventData.interfaceDataField$/*STATUS*/.status/*END_STATUS*/);/*END_RETURN_PARAM*/
-                  m_stateMachine.submitEvent("$eventData.componentName$.$eventData.functionName$.Return", data);
-                  RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "$eventData.componentName$.$eventData.functionName$.Return");
-                  return;
-              }
-          }
-          else if(futureResult == rclcpp::FutureReturnCode::TIMEOUT){
-              RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Timed out while future complete for the service '$eventData.functionName$'.");
+          if (response && response->is_ok == true) {
+              SkillEventData data;
+              data.insert("is_ok", true);/*RETURN_PARAM_LIST*//*RETURN_PARAM*/
+              data.insert("$eventData.interfaceDataField$", toEventValue(response->$eventData.interfaceDataField$/*STATUS*/.status/*END_STATUS*/));/*END_RETURN_PARAM*/
+              m_stateMachine.submitEvent("$eventData.componentName$.$eventData.functionName$.Return", data);
+              RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "$eventData.componentName$.$eventData.functionName$.Return");
+              return;
           }
+          SkillEventData data;
+          data.insert("is_ok", false);
+          m_stateMachine.submitEvent("$eventData.componentName$.$eventData.functionName$.Return", data);
+          RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "$eventData.componentName$.$eventData.functionName$.Return");
+      };
+      // getters with a <cache> in interfaces.xml answer from ComponentResponseCache while fresh
+      auto cached = ComponentResponseCache::instance().get<$eventData.interfaceName$::srv::$eventData.functionName$>(m_node, "$eventData.interfaceName$", "$eventData.functionName$", *request);
+      if (cached) {
+          returned(cached);
+          return;
       }
-      QVariantMap data;
-      data.insert("is_ok", false);
-      m_stateMachine.submitEvent("$eventData.componentName$.$eventData.functionName$.Return", data);
-      RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "$eventData.componentName$.$eventData.functionName$.Return");
-  });/*END_SEND_EVENT_SRV*/
+      m_introspection->apply(*$eventData.clientName$, $eventData.serverName$);
+      AsyncComponentCall<$eventData.interfaceName$::srv::$eventData.functionName$>::send(m_node, m_clientCallbackGroup, $eventData.clientName$, request, std::chrono::seconds(SERVICE_TIMEOUT),
+          [returned, request](std::shared_ptr<$eventData.interfaceName$::srv::$eventData.functionName$::Response> response) {
+              auto& cache = ComponentResponseCache::instance();
+              // even without a reply the component may have applied the request
+              cache.invalidateGetters("$eventData.interfaceName$", "$eventData.functionName$");
+              if (response && response->is_ok == true) {
+                  cache.put<$eventData.interfaceName$::srv::$eventData.functionName$>("$eventData.interfaceName$", "$eventData.functionName$", *request, response);
+              }
+              returned(response);
+          });
+  });
+  }/*END_SEND_EVENT_SRV*/
   /*TICK_RESPONSE*/
-  m_stateMachine.connectToEvent("TICK_RESPONSE", [this]([[maybe_unused]]const QScxmlEvent & event){
-    RCLCPP_INFO(m_node->get_logger(), "$className$::tickReturn %s", event.data().toMap()["status"].toString().toStdString().c_str());
-    std::string result = event.data().toMap()["status"].toString().toStdString();
-    if (result == std::to_string(SKILL_SUCCESS) )
+  m_stateMachine.connectToEvent("TICK_RESPONSE", [this]([[maybe_unused]]const SkillEvent & event){
+    int result = eventValue<int>(event, "status");
+    RCLCPP_INFO(m_node->get_logger(), "$className$::tickReturn %d", result);
+    std::lock_guard<std::mutex> lock(m_responseMutex);
+    if (result == SKILL_SUCCESS )
     {
       m_tickResult.store(Status::success);
     }/*ACTION*/
-    else if (result == std::to_string(SKILL_RUNNING) )
+    else if (result == SKILL_RUNNING )
     {
       m_tickResult.store(Status::running);
     }/*END_ACTION*/
-    else if (result == std::to_string(SKILL_FAILURE) )
+    else if (result == SKILL_FAILURE )
     { 
       m_tickResult.store(Status::failure);
     }
+    m_responseCondition.notify_all();
   });/*END_TICK_RESPONSE*/
     /*HALT_RESPONSE*/
-  m_stateMachine.connectToEvent("HALT_RESPONSE", [this]([[maybe_unused]]const QScxmlEvent & event){
+  m_stateMachine.connectToEvent("HALT_RESPONSE", [this]([[maybe_unused]]const SkillEvent & event){
     RCLCPP_INFO(m_node->get_logger(), "$className$::haltresponse");
+    std::lock_guard<std::mutex> lock(m_responseMutex);
     m_haltResult.store(true);
+    m_responseCondition.notify_all();
   });/*END_HALT_RESPONSE*/
 
   /*ACTION_LAMBDA_LIST*/
-  /*ACTION_SEND_GOAL*/m_stateMachine.connectToEvent("$eventData.componentName$.$eventData.functionName$.SendGoal", [this]([[maybe_unused]]const QScxmlEvent & event){
+  /*ACTION_SEND_GOAL*/m_stateMachine.connectToEvent("$eventData.componentName$.$eventData.functionName$.SendGoal", [this]([[maybe_unused]]const SkillEvent & event){
     RCLCPP_INFO(m_node->get_logger(), "$className$::$eventData.componentName$.$eventData.functionName$.SendGoal");
     RCLCPP_INFO(m_node->get_logger(), "calling send goal");
-    std::shared_ptr<rclcpp::Node> node$eventData.functionName$ = rclcpp::Node::make_shared(m_name + "SkillNode$eventData.functionName$");
-    rclcpp_action::Client<$eventData.interfaceName$::action::$eventData.functionName$>::SharedPtr client$eventData.functionName$  =
-    rclcpp_action::create_client<$eventData.interfaceName$::action::$eventData.functionName$>(node$eventData.functionName$, "/$eventData.componentName$/$eventData.functionName$");
+    // the goal goes through m_actionClient, created once in start()
     $eventData.interfaceName$::action::$eventData.functionName$::Goal goal_msg;
     /*SEND_PARAM_LIST*//*SEND_PARAM*/
-    std::string temp = event.data().toMap()["$IT->FIRST$"].toString().toStdString();
-    goal_msg.$IT->FIRST$ = convert<decltype(goal_msg.$IT->FIRST$)>(temp);
+    goal_msg.$IT->FIRST$ = eventValue<decltype(goal_msg.$IT->FIRST$)>(event, "$IT->FIRST$");
     /*END_SEND_PARAM*/
     send_goal(goal_msg);
     RCLCPP_INFO(m_node->get_logger(), "done send goal");
   });
   /*END_ACTION_SEND_GOAL*/
-  /*ACTION_RESULT_REQUEST*/m_stateMachine.connectToEvent("$eventData.componentName$.$eventData.functionName$.ResultRequest", [this]([[maybe_unused]]const QScxmlEvent & event){
+  /*ACTION_RESULT_REQUEST*/m_stateMachine.connectToEvent("$eventData.componentName$.$eventData.functionName$.ResultRequest", [this]([[maybe_unused]]const SkillEvent & event){
       RCLCPP_INFO(m_node->get_logger(), "$className$::$eventData.componentName$.$eventData.functionName$.ResultRequest");
-      std::shared_ptr<rclcpp::Node> node$eventData.functionName$ = rclcpp::Node::make_shared(m_name + "SkillNode$eventData.functionName$");
-      rclcpp_action::Client<$eventData.interfaceName$::action::$eventData.functionName$>::SharedPtr client$eventData.functionName$  =
-        rclcpp_action::create_client<$eventData.interfaceName$::action::$eventData.functionName$>(node$eventData.functionName$, "/$eventData.componentName$/GoToPoi");
       RCLCPP_INFO(m_node->get_logger(), "result request");
   });
   /*END_ACTION_RESULT_REQUEST*/
-  /*ACTION_FEEDBACK*/m_stateMachine.connectToEvent("$eventData.componentName$.$eventData.functionName$.Feedback", [this]([[maybe_unused]]const QScxmlEvent & event){
+  /*ACTION_FEEDBACK*/m_stateMachine.connectToEvent("$eventData.componentName$.$eventData.functionName$.Feedback", [this]([[maybe_unused]]const SkillEvent & event){
       RCLCPP_INFO(m_node->get_logger(), "$eventData.componentName$.$eventData.functionName$.Feedback");
-      QVariantMap data;
+      SkillEventData data;
       m_feedbackMutex.lock();
       /*FEEDBACK_PARAM_LIST*//*FEEDBACK_PARAM*/
-      data.insert("$eventData.interfaceDataField$", m_$eventData.interfaceDataField$);
+      data.insert("$eventData.interfaceDataField$", toEventValue(m_$eventData.interfaceDataField$));
       /*END_FEEDBACK_PARAM*/
       m_feedbackMutex.unlock();
       m_stateMachine.submitEvent("$eventData.componentName$.$eventData.functionName$.FeedbackReturn", data);
@@ -187,7 +298,13 @@ bool $className$::start(int argc, char*argv[])
   });/*END_ACTION_FEEDBACK*/
 
 	m_stateMachine.start();
-	m_threadSpin = std::make_shared<std::thread>(spin, m_node);
+	/*TICK*/// inside skill_host the node joins the executor shared by all the skills of the process
+	if (SkillHost::instance().add(m_node, m_clientCallbackGroup)) {
+		return true;
+	}/*END_TICK*/
+	m_executor = std::make_shared<rclcpp::executors::MultiThreadedExecutor>(rclcpp::ExecutorOptions(), 2);
+	m_executor->add_node(m_node);
+	m_threadSpin = std::make_shared<std::thread>(&$className$::spin, this);
 
 	return true;
 }
@@ -197,29 +314,56 @@ void $className$::tick( [[maybe_unused]] const std::shared_ptr<bt_interfaces_dum
 {
   std::lock_guard<std::mutex> lock(m_requestMutex);
   RCLCPP_INFO(m_node->get_logger(), "$className$::tick");
-  m_tickResult.store(Status::undefined);
+  response->status = tickStateMachine();
+  RCLCPP_INFO(m_node->get_logger(), "$className$::tickDone");
+  response->is_ok = true;
+}
+
+int8_t $className$::tickStateMachine(bool publishAlways)
+{
+  {
+      std::lock_guard<std::mutex> lock(m_responseMutex);
+      m_tickResult.store(Status::undefined);
+  }
+  // not under m_responseMutex: the table state machine answers on this thread
   m_stateMachine.submitEvent("CMD_TICK");
-  
-  while(m_tickResult.load()== Status::undefined) {
-      std::this_thread::sleep_for (std::chrono::milliseconds(100));
+  Status result;
+  {
+      std::unique_lock<std::mutex> lock(m_responseMutex);
+      m_responseCondition.wait(lock, [this]() { return m_tickResult.load() != Status::undefined; });
+      result = m_tickResult.load();
   }
-  switch(m_tickResult.load()) 
+  int8_t status = SKILL_FAILURE;
+  switch(result) 
   {
       /*ACTION*/case Status::running:
-          response->status = SKILL_RUNNING;
+          status = SKILL_RUNNING;
           break;/*END_ACTION*/
       case Status::failure:
-          response->status = SKILL_FAILURE;
+          status = SKILL_FAILURE;
           break;
       case Status::success:
-          response->status = SKILL_SUCCESS;
+          status = SKILL_SUCCESS;
           break;  
       case Status::undefined:
-          response->status = SKILL_FAILURE;
+          status = SKILL_FAILURE;
           break;          
   }
-  RCLCPP_INFO(m_node->get_logger(), "$className$::tickDone");
-  response->is_ok = true;
+  publishStatus(status, publishAlways);
+  return status;
+}
+
+void $className$::publishStatus(int8_t status, bool publishAlways)
+{
+  // latched topic read by the cached ROS2Condition leaves: a tick publishes
+  // changes only, the periodic evaluation every status
+  if (!publishAlways && m_lastPublishedStatus && *m_lastPublishedStatus == status) {
+      return;
+  }
+  m_lastPublishedStatus = status;
+  bt_interfaces_dummy::msg::$skillType$Response msg;
+  msg.status = status;
+  m_statusPublisher->publish(msg);
 }/*END_TICK_CMD*/
 /*HALT_CMD*/
 void $className$::halt( [[maybe_unused]] const std::shared_ptr<bt_interfaces_dummy::srv::Halt$skillType$::Request> request,
@@ -227,10 +371,14 @@ void $className$::halt( [[maybe_unused]] const std::shared_ptr<bt_interfaces_dum
 {
   std::lock_guard<std::mutex> lock(m_requestMutex);
   RCLCPP_INFO(m_node->get_logger(), "$className$::halt");
-  m_haltResult.store(false);
+  {
+      std::lock_guard<std::mutex> responseLock(m_responseMutex);
+      m_haltResult.store(false);
+  }
   m_stateMachine.submitEvent("CMD_HALT");
-  while(!m_haltResult.load()) {
-      std::this_thread::sleep_for (std::chrono::milliseconds(100));
+  {
+      std::unique_lock<std::mutex> responseLock(m_responseMutex);
+      m_responseCondition.wait(responseLock, [this]() { return m_haltResult.load(); });
   }
   RCLCPP_INFO(m_node->get_logger(), "$className$::haltDone");
   response->is_ok = true;
@@ -241,8 +389,8 @@ void $className$::halt( [[maybe_unused]] const std::shared_ptr<bt_interfaces_dum
 /*TOPIC_CALLBACK_LIST*//*TOPIC_CALLBACK*/
 void $className$::topic_callback_$eventData.functionName$(const $eventData.interfaceData[interfaceDataType]$::SharedPtr msg) {
   std::cout << "callback" << std::endl;
-  QVariantMap data;
-  data.insert("$eventData.interfaceData[interfaceDataField]$", msg->data);
+  SkillEventData data;
+  data.insert("$eventData.interfaceData[interfaceDataField]$", toEventValue(msg->data));
 
   m_stateMachine.submitEvent("$eventData.componentName$.$eventData.functionName$.Sub", data);
   RCLCPP_INFO(m_node->get_logger(), "$eventData.componentName$.$eventData.functionName$.Sub");
@@ -267,7 +415,7 @@ void $className$::send_goal($eventData.interfaceName$::action::$eventData.functi
     if(retries == SERVICE_TIMEOUT) {
       RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Timed out while waiting for the service '$eventData.functionName$'.");
       wait_succeded = false;
-      QVariantMap data;
+      SkillEventData data;
       data.insert("is_ok", false);
       m_stateMachine.submitEvent("$eventData.componentName$.$eventData.functionName$.GoalResponse", data);
       break;
@@ -275,8 +423,9 @@ void $className$::send_goal($eventData.interfaceName$::action::$eventData.functi
   }
   if (wait_succeded) {
       RCLCPP_INFO(m_node->get_logger(), "Sending goal");
+      m_goalSentAt = std::chrono::steady_clock::now();
       m_actionClient->async_send_goal(goal_msg, m_send_goal_options);
-      QVariantMap data;
+      SkillEventData data;
       data.insert("is_ok", true);
       m_stateMachine.submitEvent("$eventData.componentName$.$eventData.functionName$.GoalResponse", data);
     }
@@ -287,7 +436,7 @@ void $className$::send_goal($eventData.interfaceName$::action::$eventData.functi
 void $className$::goal_response_callback(const rclcpp_action::ClientGoalHandle<$eventData.interfaceName$::action::$eventData.functionName$>::SharedPtr & goal_handle)
 {
   std::cout << "Provaa" << std::endl;
-  QVariantMap data;
+  SkillEventData data;
   if (!goal_handle) {
     data.insert("is_ok", false);
     m_stateMachine.submitEvent("$eventData.componentName$.$eventData.functionName$.GoalResponse", data);
@@ -331,7 +480,10 @@ void $className$::result_callback(const  rclcpp_action::ClientGoalHandle<$eventD
   }
   //std::cout << "Result received: " << result.result->is_ok << std::endl;
   RCLCPP_INFO(m_node->get_logger(), "Result received: %d ", result.result->is_ok);
-  QVariantMap data;
+  if (m_profiler) {
+    m_profiler->recordCall("$eventData.componentName$.$eventData.functionName$", std::chrono::steady_clock::now() - m_goalSentAt);
+  }
+  SkillEventData data;
   data.insert("is_ok", result.result->is_ok);
   m_stateMachine.submitEvent("$eventData.componentName$.$eventData.functionName$.ResultResponse", data);
   RCLCPP_INFO(rclcpp::get_logger("rclcpp"), "$eventData.componentName$.$eventData.functionName$.ResultResponse");
@@ -1,11 +1,45 @@
+#ifndef SKILL_TABLE_SM
 #include <QCoreApplication>
 #include <QScxmlStateMachine>
 #include <QDebug>
+#endif
 #include <iostream>
+#include <future>
 #include <thread>
 #include <chrono>
 #include "$className$.h"
 
+#ifdef SKILL_PLUGIN
+// created and destroyed by SkillPluginLoader, never by static destruction
+static $className$* skill = nullptr;
+
+// entry points of the plugin build, called by SkillPluginLoader on the thread
+// running the Qt event loop of the host process
+extern "C" bool createSkillPlugin()
+{
+  skill = new $className$("$skillName$");
+  return skill->start(0, nullptr);
+}
+
+extern "C" void destroySkillPlugin()
+{
+  delete skill;
+  skill = nullptr;
+}
+#elif defined(SKILL_TABLE_SM)
+int main(int argc, char *argv[])
+{
+  // the table state machine runs on the threads submitting its events, there
+  // is no event loop to run: wait for the ROS context to shut down
+  $className$ stateMachine("$skillName$");
+  stateMachine.start(argc, argv);
+  std::promise<void> shutdown;
+  rclcpp::on_shutdown([&shutdown]() { shutdown.set_value(); });
+  shutdown.get_future().wait();
+
+  return 0;
+}
+#else
 int main(int argc, char *argv[])
 {
   QCoreApplication app(argc, argv);
@@ -16,4 +50,4 @@ int main(int argc, char *argv[])
   
   return ret;
 }
-
+#endif